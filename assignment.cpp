@@ -0,0 +1,88 @@
+/*********************************************************************************
+  * FileName:  assignment.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  最小费用指派，用于缩容时把一批块整体分配到目标节点
+**********************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include "assignment.h"
+
+using namespace std;
+
+void AssignmentSolver::Reset(int row_num, int col_num) {
+    rows = row_num;
+    cols = col_num;
+    cost_matrix.assign((size_t)rows * cols, -1);
+}
+
+int AssignmentSolver::Solve(vector<int> &assign) {
+    //列数少于行数时增广路可能不存在，下面的循环不会结束
+    if (rows > cols) {
+        assign.assign(rows, -1);
+        return 0;
+    }
+    //禁止元素的费用取为比任何不含禁止元素的指派的总费用都大的值
+    long long max_cost = 0;
+    for (size_t i = 0; i < cost_matrix.size(); i++) {
+        max_cost = max(max_cost, cost_matrix[i]);
+    }
+    const long long forbidden = (max_cost + 1) * (rows + 1);
+    const long long inf = numeric_limits<long long>::max();
+    u.assign(rows + 1, 0);
+    v.assign(cols + 1, 0);
+    match.assign(cols + 1, 0);
+    way.assign(cols + 1, 0);
+    for (int i = 1; i <= rows; i++) {
+        //从虚拟列0出发，为第i行找一条约化费用最小的增广路
+        match[0] = i;
+        int j0 = 0;
+        min_slack.assign(cols + 1, inf);
+        used.assign(cols + 1, 0);
+        do {
+            used[j0] = 1;
+            int i0 = match[j0];
+            const long long *row = &cost_matrix[(size_t)(i0 - 1) * cols];
+            long long delta = inf;
+            int j1 = 0;
+            for (int j = 1; j <= cols; j++) {
+                if (used[j]) continue;
+                long long c = row[j - 1] < 0 ? forbidden : row[j - 1];
+                long long cur = c - u[i0] - v[j];
+                if (cur < min_slack[j]) {
+                    min_slack[j] = cur;
+                    way[j] = j0;
+                }
+                if (min_slack[j] < delta) {
+                    delta = min_slack[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= cols; j++) {
+                if (used[j]) {
+                    u[match[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    min_slack[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (match[j0] != 0);
+        //沿增广路翻转匹配
+        do {
+            int j1 = way[j0];
+            match[j0] = match[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    assign.assign(rows, -1);
+    int assigned = 0;
+    for (int j = 1; j <= cols; j++) {
+        int i = match[j];
+        if (i == 0 || cost_matrix[(size_t)(i - 1) * cols + j - 1] < 0) continue;
+        assign[i - 1] = j - 1;
+        assigned++;
+    }
+    return assigned;
+}
@@ -0,0 +1,49 @@
+/*********************************************************************************
+  * FileName:  assignment.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  最小费用指派，用于缩容时把一批块整体分配到目标节点
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_ASSIGNMENT_H
+#define SUD_SCALE_SIMULATION_ASSIGNMENT_H
+
+#include <vector>
+using namespace std;
+
+/*
+ * rows个行（块）与cols个列（目标节点）之间的最小费用指派，要求rows <= cols，每列至多指派一行。
+ * 这是源点-行-列-汇点、容量均为1的最小费用流，用带势的最短增广路（匈牙利算法）求解：逐行加入，
+ * 每次在稠密的费用矩阵上找一条约化费用最小的增广路，复杂度为O(rows^2 * cols)，实际中每行的增广路通常很短。
+ * 费用矩阵与各数组在多次求解之间复用
+ */
+class AssignmentSolver {
+public:
+    /**
+     * @brief   设置行数与列数，并把所有元素设为禁止
+     */
+    void Reset(int row_num, int col_num);
+    /**
+     * @brief   设置第row行指派到第col列的费用，cost必须非负；未设置的元素表示禁止指派
+     */
+    void SetCost(int row, int col, long long cost) { cost_matrix[(size_t)row * cols + col] = cost; }
+    /**
+     * @brief   求总费用最小的指派，在存在不使用禁止元素的完整指派时一定不使用禁止元素
+     * @param   assign  返回每行指派到的列，指派到禁止元素的行为-1
+     * @return  指派成功的行数；rows > cols时不求解，所有行都为-1，返回0
+     */
+    int Solve(vector<int> &assign);
+
+private:
+    int rows;
+    int cols;
+    vector<long long> cost_matrix;  //按行存储，-1表示禁止
+    vector<long long> u;            //行的势
+    vector<long long> v;            //列的势
+    vector<int> match;              //match[j]为指派到第j列的行（从1开始），0表示未指派；第0列为虚拟列
+    vector<int> way;                //增广路中到达每列的前一列
+    vector<long long> min_slack;
+    vector<char> used;
+};
+
+#endif //SUD_SCALE_SIMULATION_ASSIGNMENT_H
@@ -0,0 +1,220 @@
+/*********************************************************************************
+  * FileName:  bench.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  各个模块的性能对比测试
+**********************************************************************************/
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "bench.h"
+#include "simulator.h"
+#include "simd.h"
+
+using namespace std;
+
+/**
+ * @brief   统计各节点块数的最大值与最小值之差，用于确认放置结果是均衡的
+ */
+static int LoadSpread(const DiskBlockSet &disks, int disk_num) {
+    int max_load = 0;
+    int min_load = disks[0].size();
+    for (int i = 0; i < disk_num; i++) {
+        int load = disks[i].size();
+        max_load = load > max_load ? load : max_load;
+        min_load = load < min_load ? load : min_load;
+    }
+    return max_load - min_load;
+}
+
+/**
+ * @brief   对比InitDisks中排序放置与最小堆放置的耗时，每种规模各运行若干次取最小值
+ */
+int RunPlacementBench(ostream &out) {
+    const int repeat = 3;
+    const int scales[][2] = {{12, 6000}, {120, 60000}, {1000, 100000}};
+    const char *names[] = {"heap", "sort"};
+    SUDSimulator sim;
+    out << "disks,stripes,placement,best_ms,load_spread" << endl;
+    for (int s = 0; s < sizeof(scales) / sizeof(scales[0]); s++) {
+        for (int p = 0; p < 2; p++) {
+            SimConfig cfg;
+            cfg.disk_num_origin = scales[s][0];
+            cfg.disk_num_after_scale = scales[s][0];
+            cfg.stripe_num = scales[s][1];
+            cfg.verbose = VERBOSE_QUIET;
+            cfg.placement = p;
+            double best = -1;
+            int spread = 0;
+            for (int r = 0; r < repeat; r++) {
+                sim.Reset(cfg);
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                sim.InitDisks();
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                best = (best < 0 || ms < best) ? ms : best;
+                spread = LoadSpread(sim.GetDisks(), cfg.disk_num_origin);
+            }
+            out << cfg.disk_num_origin << "," << cfg.stripe_num << "," << names[p] << "," << best << ","
+                 << spread << endl;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   在1k~10k节点的随机邻接矩阵上，对比各指令集下行最大值与最优解检查两个内核的耗时
+ */
+int RunKernelBench(ostream &out) {
+    const int repeat = 3;
+    const int sizes[] = {1000, 2000, 5000, 10000};
+    const int widths[] = {4, 8, 16};
+    const int checks = 1000000;
+    int supported = DetectSimdLevel();
+    int saved = GetSimdLevel();
+    mt19937 gen(1);
+    vector<edge_t> matrix;
+    vector<int> cols;
+    vector<int> rows;
+    out << "kernel,disks,width,simd,best_ms,ns_per_op,checksum" << endl;
+    for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int d = sizes[s];
+        matrix.resize((size_t)d * d);
+        uniform_int_distribution<int> value(0, 1000);
+        for (size_t i = 0; i < matrix.size(); i++) {
+            matrix[i] = value(gen);
+        }
+        //行最大值：扫描全部d行
+        for (int level = SIMD_SCALAR; level <= supported; level++) {
+            SetSimdLevel(level);
+            double best = -1;
+            long long checksum = 0;
+            for (int r = 0; r < repeat; r++) {
+                checksum = 0;
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                for (int i = 0; i < d; i++) {
+                    int arg;
+                    checksum += RowArgMaxKernel(&matrix[(size_t)i * d], d, arg) + arg;
+                }
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                best = (best < 0 || ms < best) ? ms : best;
+            }
+            out << "row_argmax," << d << "," << d << "," << SimdLevelName(level) << "," << best << ","
+                 << best * 1e6 / d << "," << checksum << endl;
+        }
+        //最优解检查：随机选取行与条带成员，limit取最大值使检查不会提前结束
+        uniform_int_distribution<int> disk(0, d - 1);
+        for (int w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+            int width = widths[w];
+            cols.resize((size_t)checks * width);
+            rows.resize(checks);
+            for (int i = 0; i < checks; i++) {
+                rows[i] = disk(gen);
+                for (int m = 0; m < width; m++) {
+                    cols[(size_t)i * width + m] = disk(gen);
+                }
+            }
+            for (int level = SIMD_SCALAR; level <= supported; level++) {
+                SetSimdLevel(level);
+                double best = -1;
+                long long checksum = 0;
+                for (int r = 0; r < repeat; r++) {
+                    checksum = 0;
+                    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                    for (int i = 0; i < checks; i++) {
+                        const int *c = &cols[(size_t)i * width];
+                        checksum += AnyAtLeastKernel(&matrix[(size_t)rows[i] * d], c, width, c[0], 1001);
+                    }
+                    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    best = (best < 0 || ms < best) ? ms : best;
+                }
+                out << "any_at_least," << d << "," << width << "," << SimdLevelName(level) << "," << best << ","
+                     << best * 1e6 / checks << "," << checksum << endl;
+            }
+        }
+    }
+    SetSimdLevel(saved);
+    return 0;
+}
+
+/**
+ * @brief   对各规模依次测量每个阶段的耗时。每次迭代都从新的随机布局开始，种子由迭代序号决定，
+            因此同一版本多次运行时每个阶段处理的数据相同；预热迭代不计时
+ */
+int RunPhaseBench(const BenchOptions &opts, ostream &out) {
+    static const char *phase_name[] = {"init_disks", "init_graph", "expand", "shrink", "redistribute", "redistribute_swap",
+                                        "evaluation"};
+    const int phase_num = sizeof(phase_name) / sizeof(phase_name[0]);
+    SUDSimulator sim;
+    vector<double> samples;
+    if (opts.json) {
+        out << "{\"simd\": \"" << SimdLevelName(GetSimdLevel()) << "\", \"build_type\": \"" << opts.build_type
+            << "\", \"edge_bits\": " << sizeof(edge_t) * 8 << ", \"repeat\": " << opts.repeat
+            << ", \"warmup\": " << opts.warmup << ", \"results\": [";
+    } else {
+        out << "small,large,stripes,n,phase,simd,repeat,min_ms,median_ms,mean_ms,max_ms,fatal" << endl;
+    }
+    int first = 1;
+    for (int c = 0; c < opts.cases.size(); c++) {
+        const BenchCase &bc = opts.cases[c];
+        for (int p = 0; p < phase_num; p++) {
+            SimConfig cfg;
+            cfg.n = opts.n;
+            cfg.k = opts.k;
+            cfg.stripe_num = bc.stripes;
+            cfg.verbose = VERBOSE_QUIET;
+            //扩容与评估从small个节点到large个节点，缩容相反，两种重分布都在small个节点上进行
+            cfg.disk_num_origin = p == 3 ? bc.large : bc.small;
+            cfg.disk_num_after_scale = (p >= 3 && p <= 5) ? bc.small : bc.large;
+            cfg.redistribute = p == 5 ? REDIST_SWAP : REDIST_VIRTUAL;
+            cfg.evaluation = p == 6;
+            string err;
+            if (ValidateConfig(cfg, err) != 0) {
+                cerr << "Error: " << bc.small << "->" << bc.large << "，" << bc.stripes << "个条带：" << err << endl;
+                return 1;
+            }
+            samples.clear();
+            int fatal = 0;
+            for (int it = 0; it < opts.warmup + opts.repeat; it++) {
+                cfg.seed = it + 1;
+                sim.Reset(cfg);
+                if (p >= 1 && p <= 5) sim.InitDisks();
+                if (p >= 2 && p <= 5) sim.InitGraph();
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                switch (p) {
+                    case 0: sim.InitDisks(); break;
+                    case 1: sim.InitGraph(); break;
+                    case 2: sim.SUDExpand(); break;
+                    case 3: sim.SUDShrink(); break;
+                    case 4:
+                    case 5: sim.Redistribute(); break;
+                    default: sim.Evaluation(); break;
+                }
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                if (it >= opts.warmup) samples.push_back(ms);
+                fatal |= sim.Fatal();
+            }
+            sort(samples.begin(), samples.end());
+            double mean = 0;
+            for (int i = 0; i < samples.size(); i++) mean += samples[i];
+            mean /= samples.size();
+            double median = samples.size() % 2 ? samples[samples.size() / 2]
+                                               : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+            if (opts.json) {
+                out << (first ? "" : ",") << "\n  {\"small\": " << bc.small << ", \"large\": " << bc.large
+                    << ", \"stripes\": " << bc.stripes << ", \"n\": " << cfg.n << ", \"phase\": \""
+                    << phase_name[p] << "\", \"min_ms\": " << samples.front() << ", \"median_ms\": " << median
+                    << ", \"mean_ms\": " << mean << ", \"max_ms\": " << samples.back() << ", \"fatal\": "
+                    << fatal << "}";
+            } else {
+                out << bc.small << "," << bc.large << "," << bc.stripes << "," << cfg.n << "," << phase_name[p] << ","
+                    << SimdLevelName(GetSimdLevel()) << "," << opts.repeat << "," << samples.front() << "," << median
+                    << "," << mean << "," << samples.back() << "," << fatal << endl;
+            }
+            first = 0;
+        }
+    }
+    if (opts.json) out << "\n]}" << endl;
+    return 0;
+}
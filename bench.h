@@ -0,0 +1,37 @@
+/*********************************************************************************
+  * FileName:  bench.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  各个模块的性能对比测试，由sud_bench调用
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_BENCH_H
+#define SUD_SCALE_SIMULATION_BENCH_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*一组测试规模：扩容与评估为small->large，缩容为large->small，重分布在small个节点上进行*/
+struct BenchCase {
+    int small;
+    int large;
+    int stripes;
+};
+
+struct BenchOptions {
+    vector<BenchCase> cases;
+    int n = 4;
+    int k = 3;
+    int repeat = 5;         //计时的迭代次数
+    int warmup = 1;         //不计时的预热迭代次数
+    int json = 0;           //输出JSON，否则输出CSV
+    string build_type;      //编译类型，写入JSON输出以便区分不同构建的结果
+};
+
+int RunPlacementBench(ostream &out);
+int RunKernelBench(ostream &out);
+int RunPhaseBench(const BenchOptions &opts, ostream &out);
+
+#endif //SUD_SCALE_SIMULATION_BENCH_H
@@ -0,0 +1,130 @@
+/*********************************************************************************
+  * FileName:  bench_main.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  sud_bench入口，按阶段测量各规模下的耗时，输出CSV或JSON便于跨版本对比
+**********************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include "bench.h"
+#include "config.h"
+#include "simd.h"
+
+using namespace std;
+
+#ifndef SUD_BUILD_TYPE
+#define SUD_BUILD_TYPE ""
+#endif
+
+/*quick覆盖到几百个节点，一两分钟内完成；full追加到上万节点、千万条带，需要数小时*/
+static const BenchCase g_QuickCases[] = {{12, 16, 6000}, {120, 160, 60000}, {400, 480, 240000}};
+static const BenchCase g_FullCases[] = {{1000, 1200, 600000}, {2000, 2400, 1200000}, {8000, 10000, 10000000}};
+
+static void PrintBenchUsage(const char *prog) {
+    cout << "用法: " << prog << " [选项]" << endl
+         << "  --suite S        phases(默认，各阶段耗时)、placement、kernels或all" << endl
+         << "  --preset P       phases的规模: quick(默认)或full（追加到1万节点、1000万条带）" << endl
+         << "  --case S:L:T     自定义规模，small:large:stripes，可重复指定，指定后不使用preset" << endl
+         << "  --n N            条带长度 (默认4)" << endl
+         << "  --k N            恢复一个块需要读取的块数 (默认3)" << endl
+         << "  --repeat N       计时的迭代次数 (默认5)" << endl
+         << "  --warmup N       不计时的预热迭代次数 (默认1)" << endl
+         << "  --format F       phases的输出格式: csv(默认)或json" << endl
+         << "  --out FILE       结果输出文件 (默认标准输出)" << endl
+         << "  --simd L         邻接矩阵内核使用的指令集: auto(默认)、scalar、sse4.1或avx2" << endl;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opts;
+    opts.build_type = SUD_BUILD_TYPE;
+    string suite = "phases";
+    string preset = "quick";
+    string format = "csv";
+    string output_file;
+    string simd = "auto";
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            PrintBenchUsage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Error: 未知选项或缺少参数 " << arg << endl;
+            PrintBenchUsage(argv[0]);
+            return 1;
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--suite") == 0) suite = value;
+        else if (strcmp(arg, "--preset") == 0) preset = value;
+        else if (strcmp(arg, "--format") == 0) format = value;
+        else if (strcmp(arg, "--out") == 0) output_file = value;
+        else if (strcmp(arg, "--simd") == 0) simd = value;
+        else if (strcmp(arg, "--n") == 0 || strcmp(arg, "--k") == 0 || strcmp(arg, "--repeat") == 0 ||
+                 strcmp(arg, "--warmup") == 0) {
+            int *target = strcmp(arg, "--n") == 0 ? &opts.n : strcmp(arg, "--k") == 0 ? &opts.k
+                        : strcmp(arg, "--repeat") == 0 ? &opts.repeat : &opts.warmup;
+            if (ParseInt(value, *target) != 0) {
+                cerr << "Error: " << arg << " 的参数不是int范围内的整数: " << value << endl;
+                return 1;
+            }
+        } else if (strcmp(arg, "--case") == 0) {
+            BenchCase bc;
+            if (sscanf(value, "%d:%d:%d", &bc.small, &bc.large, &bc.stripes) != 3 || bc.small >= bc.large) {
+                cerr << "Error: --case 的格式应为small:large:stripes，且small < large: " << value << endl;
+                return 1;
+            }
+            opts.cases.push_back(bc);
+        } else {
+            cerr << "Error: 未知选项 " << arg << endl;
+            PrintBenchUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (opts.repeat < 1 || opts.warmup < 0) {
+        cerr << "Error: --repeat 必须为正，--warmup 不能为负" << endl;
+        return 1;
+    }
+    if (simd == "scalar") SetSimdLevel(SIMD_SCALAR);
+    else if (simd == "sse4.1") SetSimdLevel(SIMD_SSE41);
+    else if (simd == "avx2") SetSimdLevel(SIMD_AVX2);
+    else if (simd != "auto") {
+        cerr << "Error: 未知的指令集 " << simd << endl;
+        return 1;
+    }
+    if (format != "csv" && format != "json") {
+        cerr << "Error: 未知的输出格式 " << format << endl;
+        return 1;
+    }
+    opts.json = format == "json";
+    if (opts.cases.empty()) {
+        if (preset != "quick" && preset != "full") {
+            cerr << "Error: 未知的规模 " << preset << endl;
+            return 1;
+        }
+        opts.cases.assign(g_QuickCases, g_QuickCases + sizeof(g_QuickCases) / sizeof(g_QuickCases[0]));
+        if (preset == "full")
+            opts.cases.insert(opts.cases.end(), g_FullCases, g_FullCases + sizeof(g_FullCases) / sizeof(g_FullCases[0]));
+    }
+    ofstream file;
+    if (!output_file.empty()) {
+        file.open(output_file);
+        if (!file) {
+            cerr << "Error: 无法打开输出文件 " << output_file << endl;
+            return 1;
+        }
+    }
+    ostream &out = output_file.empty() ? cout : file;
+    int ret = 0;
+    if (suite == "phases" || suite == "all") ret |= RunPhaseBench(opts, out);
+    if (suite == "placement" || suite == "all") ret |= RunPlacementBench(out);
+    if (suite == "kernels" || suite == "all") ret |= RunKernelBench(out);
+    if (suite != "phases" && suite != "placement" && suite != "kernels" && suite != "all") {
+        cerr << "Error: 未知的测试集 " << suite << endl;
+        return 1;
+    }
+    return ret;
+}
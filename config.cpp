@@ -0,0 +1,432 @@
+/*********************************************************************************
+  * FileName:  config.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  命令行与扫参文件解析
+**********************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <climits>
+#include <cerrno>
+#include "config.h"
+#include "graph.h"
+#include "simd.h"
+#include "planwriter.h"
+
+using namespace std;
+
+/**
+ * @brief   理论最优解，即恢复时每对节点之间传输块数的下界
+ */
+int SimConfig::Optimal() const {
+    long long d = disk_num_after_scale;
+    return (int)(1 + ((long long)k * stripe_num * n) / (d * (d - 1)));
+}
+
+/**
+ * @brief   扩缩容过程中出现的最少节点数，各节点的块列表按此预留容量
+ */
+int SimConfig::MinDiskNum() const {
+    int min_disk_num = min(disk_num_origin, disk_num_after_scale);
+    for (int i = 0; i < timeline.size(); i++) {
+        min_disk_num = min(min_disk_num, timeline[i]);
+    }
+    return min_disk_num;
+}
+
+/**
+ * @brief   扩缩容过程中出现的最多节点数，包括虚拟扩容方式重分布时的虚拟节点
+ */
+int SimConfig::MaxDiskNum() const {
+    int max_disk_num = max(disk_num_origin, disk_num_after_scale);
+    for (int i = 0; i < timeline.size(); i++) {
+        max_disk_num = max(max_disk_num, timeline[i]);
+    }
+    if (evaluation == 0 && timeline.empty() && disk_num_origin == disk_num_after_scale && redistribute == REDIST_VIRTUAL)
+        max_disk_num = VirtualDiskNum();
+    return max_disk_num;
+}
+
+/**
+ * @brief   虚拟扩容方式重分布时扩容到的节点数：大于disk_num_origin且能整除总块数的最小节点数，不存在时为disk_num_origin
+ */
+int SimConfig::VirtualDiskNum() const {
+    for (int i = disk_num_origin + 1; i < g_MaxDiskNum; i++) {
+        if (TotalBlocks() % i == 0) return i;
+    }
+    return disk_num_origin;
+}
+
+void PrintUsage(const char *prog) {
+    cout << "用法: " << prog << " [选项]" << endl
+         << "  --origin N       扩缩容前的节点数 (默认12)" << endl
+         << "  --target N       扩缩容后的节点数 (默认8)" << endl
+         << "  --stripes N      条带数 (默认6000)" << endl
+         << "  --n N            条带长度 (默认4)" << endl
+         << "  --k N            恢复一个块需要读取的块数 (默认3)" << endl
+         << "  --debug          开启调试输出" << endl
+         << "  --evaluation     执行评估模式" << endl
+         << "  --trials N       重复N次评估并统计平均传输开销的分布（多线程）" << endl
+         << "  --threads N      蒙特卡洛评估的线程数 (默认使用全部核心)" << endl
+         << "  --plan-threads N 扩容时用N个线程并行规划每轮迁移，结果与线程数无关 (默认串行)" << endl
+         << "  --seed N         随机数种子，相同种子的运行结果相同 (默认使用当前时间)" << endl
+         << "  --quiet          只输出一行汇总，等价于--verbosity quiet" << endl
+         << "  --verbosity V    输出详细程度: quiet、summary或full(默认，输出每次迁移与邻接矩阵)" << endl
+         << "  --plan-out FILE  把迁移计划写入文件，由后台线程写出" << endl
+         << "  --plan-format F  迁移计划格式: csv(默认)或binary" << endl
+         << "  --dump-matrix FILE 把扩缩容后的邻接矩阵以二进制写入文件" << endl
+         << "  --stats FILE     把各阶段耗时与热点计数器（需以SUD_STATS编译）以JSON写入文件，-表示标准输出" << endl
+         << "  --layout FILE    从二进制布局文件载入初始布局，条带数、条带长度与扩缩容前的节点数取自文件" << endl
+         << "  --convert-layout TEXT 把文本布局（每行为一个条带各块所在的节点号）转换为二进制布局文件，写入--out指定的文件" << endl
+         << "  --timeline L     从--origin出发依次扩缩容到以逗号分隔的各个节点数（如16,20,18），在同一布局上连续执行，" << endl
+         << "                   输出每一步与累计的迁移块数及最大边数" << endl
+         << "  --redistribute M 节点数不变时的重分布方式: virtual(默认，虚拟扩容后缩容)、swap(在现有节点间交换块，不支持--disk-profile)" << endl
+         << "                   或compare(从同一初始布局分别执行两种方式并对比迁移块数、最大边数与耗时)" << endl
+         << "  --disk-profile FILE 各节点的容量与带宽权重，每行为: first[-last] capacity bandwidth。块数按容量比例分配，" << endl
+         << "                   理想最优解与瓶颈按恢复时间（边数除以两端带宽的较小值）计算，网络模拟中磁盘带宽按比例缩放" << endl
+         << "  --topology FILE  各节点所在的主机与机架，每行为: first[-last] host rack。维护按主机、机架聚合的邻接矩阵，" << endl
+         << "                   扩缩容时优先选择不使任何一对主机或机架之间的边数超过其上限的迁移" << endl
+         << "  --shrink M       缩容时选择目标节点的方式: first-fit(默认，逐块取第一个合适的节点)或flow(每批块按最小费用流" << endl
+         << "                   整体分配，费用为超过理论最优解的边数)" << endl
+         << "  --shrink-batch N 按批缩容时每批的块数 (默认64)，实际不超过仍有空位的目标节点数" << endl
+         << "  --placement P    InitDisks放置策略: heap(默认)或sort" << endl
+         << "  --triangular-graph 邻接矩阵只存储上三角部分，内存减半" << endl
+         << "  --recovery D     在扩缩容前后分析节点D故障时的恢复读负载，D为all时分析每个节点单独故障" << endl
+         << "  --recovery-threads N 故障分析的线程数 (默认使用全部核心)" << endl
+         << "  --netsim         按迁移计划进行离散事件网络模拟，输出完成时间、链路利用率与关键路径" << endl
+         << "  --nic-bw B       网络模拟中每个节点的网卡带宽，MB/s (默认1250)" << endl
+         << "  --disk-bw B      网络模拟中每个节点的磁盘带宽，MB/s (默认200)" << endl
+         << "  --block-size M   网络模拟中的块大小，MB (默认64)" << endl
+         << "  --streams N      网络模拟中每个节点同时发送与接收的迁移数 (默认1)" << endl
+         << "  --sweep FILE     按扫参文件批量运行，每行为: origin target stripes [n k]" << endl
+         << "  --out FILE       批量运行结果输出文件 (默认标准输出)" << endl
+         << "  --simd L         邻接矩阵内核使用的指令集: auto(默认)、scalar、sse4.1或avx2" << endl
+         << "性能测试见sud_bench" << endl;
+}
+
+/**
+ * @brief   解析整数参数，超出int范围时视为失败
+ * @return  成功返回0，失败返回-1
+ */
+int ParseInt(const char *s, int &value) {
+    char *end = nullptr;
+    errno = 0;
+    long v = strtol(s, &end, 10);
+    if (end == s || *end != '\0') return -1;
+    //long为64位时strtol不会因超出int的范围而报错，需要再检查一次
+    if (errno == ERANGE || v < INT_MIN || v > INT_MAX) return -1;
+    value = (int)v;
+    return 0;
+}
+
+/**
+ * @brief   解析正实数参数
+ * @return  成功返回0，失败返回-1
+ */
+static int ParsePositive(const char *s, double &value) {
+    char *end = nullptr;
+    double v = strtod(s, &end);
+    if (end == s || *end != '\0' || !(v > 0)) return -1;
+    value = v;
+    return 0;
+}
+
+/**
+ * @brief   解析命令行参数
+ * @return  成功返回0，参数错误返回-1，只需打印帮助时返回1
+ */
+int ParseArgs(int argc, char **argv, CliOptions &opts) {
+    SimConfig &cfg = opts.base;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        //带参数的选项
+        int *int_target = nullptr;
+        double *double_target = nullptr;
+        string *str_target = nullptr;
+        string placement;
+        string seed;
+        string simd;
+        string verbosity;
+        string plan_format;
+        string recovery;
+        string timeline;
+        string redistribute;
+        string shrink;
+        if (strcmp(arg, "--origin") == 0) int_target = &cfg.disk_num_origin;
+        else if (strcmp(arg, "--target") == 0) int_target = &cfg.disk_num_after_scale;
+        else if (strcmp(arg, "--stripes") == 0) int_target = &cfg.stripe_num;
+        else if (strcmp(arg, "--n") == 0) int_target = &cfg.n;
+        else if (strcmp(arg, "--k") == 0) int_target = &cfg.k;
+        else if (strcmp(arg, "--trials") == 0) int_target = &opts.trials;
+        else if (strcmp(arg, "--threads") == 0) int_target = &opts.threads;
+        else if (strcmp(arg, "--plan-threads") == 0) int_target = &cfg.plan_threads;
+        else if (strcmp(arg, "--recovery-threads") == 0) int_target = &cfg.recovery_threads;
+        else if (strcmp(arg, "--recovery") == 0) str_target = &recovery;
+        else if (strcmp(arg, "--streams") == 0) int_target = &opts.net.streams;
+        else if (strcmp(arg, "--nic-bw") == 0) double_target = &opts.net.nic_bw;
+        else if (strcmp(arg, "--disk-bw") == 0) double_target = &opts.net.disk_bw;
+        else if (strcmp(arg, "--block-size") == 0) double_target = &opts.net.block_mb;
+        else if (strcmp(arg, "--seed") == 0) str_target = &seed;
+        else if (strcmp(arg, "--simd") == 0) str_target = &simd;
+        else if (strcmp(arg, "--sweep") == 0) str_target = &opts.sweep_file;
+        else if (strcmp(arg, "--out") == 0) str_target = &opts.output_file;
+        else if (strcmp(arg, "--placement") == 0) str_target = &placement;
+        else if (strcmp(arg, "--verbosity") == 0) str_target = &verbosity;
+        else if (strcmp(arg, "--plan-out") == 0) str_target = &opts.plan_file;
+        else if (strcmp(arg, "--plan-format") == 0) str_target = &plan_format;
+        else if (strcmp(arg, "--dump-matrix") == 0) str_target = &opts.matrix_file;
+        else if (strcmp(arg, "--stats") == 0) str_target = &opts.stats_file;
+        else if (strcmp(arg, "--layout") == 0) str_target = &opts.layout_file;
+        else if (strcmp(arg, "--disk-profile") == 0) str_target = &opts.profile_file;
+        else if (strcmp(arg, "--topology") == 0) str_target = &opts.topology_file;
+        else if (strcmp(arg, "--convert-layout") == 0) str_target = &opts.convert_layout;
+        else if (strcmp(arg, "--timeline") == 0) str_target = &timeline;
+        else if (strcmp(arg, "--redistribute") == 0) str_target = &redistribute;
+        else if (strcmp(arg, "--shrink") == 0) str_target = &shrink;
+        else if (strcmp(arg, "--shrink-batch") == 0) int_target = &cfg.shrink_batch;
+        if (double_target != nullptr) {
+            if (i + 1 >= argc || ParsePositive(argv[i + 1], *double_target) != 0) {
+                cerr << "Error: " << arg << " 需要一个正数参数" << endl;
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        if (int_target != nullptr || str_target != nullptr) {
+            if (i + 1 >= argc) {
+                cerr << "Error: " << arg << " 缺少参数" << endl;
+                return -1;
+            }
+            if (int_target != nullptr) {
+                if (ParseInt(argv[++i], *int_target) != 0) {
+                    cerr << "Error: " << arg << " 的参数不是int范围内的整数: " << argv[i] << endl;
+                    return -1;
+                }
+            } else {
+                *str_target = argv[++i];
+            }
+            if (str_target == &seed) {
+                char *end = nullptr;
+                cfg.seed = strtoull(seed.c_str(), &end, 10);
+                if (seed.empty() || *end != '\0') {
+                    cerr << "Error: " << arg << " 的参数不是整数: " << seed << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &simd) {
+                if (simd == "auto") opts.simd_level = -1;
+                else if (simd == "scalar") opts.simd_level = SIMD_SCALAR;
+                else if (simd == "sse4.1") opts.simd_level = SIMD_SSE41;
+                else if (simd == "avx2") opts.simd_level = SIMD_AVX2;
+                else {
+                    cerr << "Error: 未知的指令集 " << simd << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &verbosity) {
+                if (verbosity == "quiet") cfg.verbose = VERBOSE_QUIET;
+                else if (verbosity == "summary") cfg.verbose = VERBOSE_SUMMARY;
+                else if (verbosity == "full") cfg.verbose = VERBOSE_FULL;
+                else {
+                    cerr << "Error: 未知的输出详细程度 " << verbosity << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &plan_format) {
+                if (plan_format == "csv") opts.plan_format = PLAN_FORMAT_CSV;
+                else if (plan_format == "binary") opts.plan_format = PLAN_FORMAT_BINARY;
+                else {
+                    cerr << "Error: 未知的迁移计划格式 " << plan_format << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &recovery) {
+                cfg.recovery = 1;
+                if (recovery == "all") cfg.recovery_disk = -1;
+                else if (ParseInt(recovery.c_str(), cfg.recovery_disk) != 0 || cfg.recovery_disk < 0) {
+                    cerr << "Error: " << arg << " 的参数应为all或节点号: " << recovery << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &timeline) {
+                //以逗号分隔的节点数序列
+                cfg.timeline.clear();
+                istringstream iss(timeline);
+                string item;
+                int value;
+                while (getline(iss, item, ',')) {
+                    if (ParseInt(item.c_str(), value) != 0) {
+                        cerr << "Error: " << arg << " 的参数应为以逗号分隔的节点数: " << timeline << endl;
+                        return -1;
+                    }
+                    cfg.timeline.push_back(value);
+                }
+                if (cfg.timeline.empty()) {
+                    cerr << "Error: " << arg << " 的参数为空" << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &redistribute) {
+                opts.redistribute_compare = 0;
+                if (redistribute == "virtual") cfg.redistribute = REDIST_VIRTUAL;
+                else if (redistribute == "swap") cfg.redistribute = REDIST_SWAP;
+                else if (redistribute == "compare") opts.redistribute_compare = 1;
+                else {
+                    cerr << "Error: 未知的重分布方式 " << redistribute << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &shrink) {
+                if (shrink == "first-fit") cfg.shrink = SHRINK_FIRST_FIT;
+                else if (shrink == "flow") cfg.shrink = SHRINK_FLOW;
+                else {
+                    cerr << "Error: 未知的缩容方式 " << shrink << endl;
+                    return -1;
+                }
+            }
+            if (str_target == &placement) {
+                if (placement == "heap") cfg.placement = 0;
+                else if (placement == "sort") cfg.placement = 1;
+                else {
+                    cerr << "Error: 未知的放置策略 " << placement << endl;
+                    return -1;
+                }
+            }
+            continue;
+        }
+        //开关选项
+        if (strcmp(arg, "--debug") == 0) {
+            cfg.debug = 1;
+        } else if (strcmp(arg, "--evaluation") == 0) {
+            cfg.evaluation = 1;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            cfg.verbose = VERBOSE_QUIET;
+        } else if (strcmp(arg, "--netsim") == 0) {
+            opts.netsim = 1;
+        } else if (strcmp(arg, "--triangular-graph") == 0) {
+            cfg.triangular_graph = 1;
+        } else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            return 1;
+        } else {
+            cerr << "Error: 未知选项 " << arg << endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   读取扫参文件。每个非空、非#开头的行描述一组参数: origin target stripes [n k]，
+            缺省的n、k取base中的值
+ * @return  成功返回0，失败返回-1
+ */
+int LoadSweepFile(const string &path, const SimConfig &base, vector<SimConfig> &configs) {
+    ifstream in(path);
+    if (!in) {
+        cerr << "Error: 无法打开扫参文件 " << path << endl;
+        return -1;
+    }
+    string line;
+    int line_no = 0;
+    while (getline(in, line)) {
+        line_no++;
+        size_t pos = line.find('#');
+        if (pos != string::npos) line.erase(pos);
+        istringstream iss(line);
+        SimConfig cfg = base;
+        if (!(iss >> cfg.disk_num_origin)) continue;    //空行
+        if (!(iss >> cfg.disk_num_after_scale >> cfg.stripe_num)) {
+            cerr << "Error: 扫参文件第" << line_no << "行格式错误" << endl;
+            return -1;
+        }
+        int n, k;
+        if (iss >> n) {
+            if (!(iss >> k)) {
+                cerr << "Error: 扫参文件第" << line_no << "行指定了n但缺少k" << endl;
+                return -1;
+            }
+            cfg.n = n;
+            cfg.k = k;
+        }
+        configs.push_back(cfg);
+    }
+    return 0;
+}
+
+/**
+ * @brief   检查参数组合是否合法
+ * @return  合法返回0，否则返回-1并在err中给出原因
+ */
+int ValidateConfig(const SimConfig &cfg, string &err) {
+    if (!cfg.timeline.empty()) {
+        //时间线的每一步都要满足与单次扩缩容相同的条件
+        SimConfig step = cfg;
+        step.timeline.clear();
+        for (int i = 0; i < cfg.timeline.size(); i++) {
+            step.disk_num_after_scale = cfg.timeline[i];
+            if (step.disk_num_after_scale == step.disk_num_origin) {
+                err = "时间线中相邻两步的节点数不能相同";
+                return -1;
+            }
+            if (ValidateConfig(step, err) != 0) {
+                err = "时间线第" + to_string(i + 1) + "步：" + err;
+                return -1;
+            }
+            step.disk_num_origin = step.disk_num_after_scale;
+        }
+        return 0;
+    }
+    if (cfg.n < 2 || cfg.k < 1 || cfg.k >= cfg.n) {
+        err = "要求 1 <= k < n 且 n >= 2";
+        return -1;
+    }
+    if (cfg.stripe_num <= 0) {
+        err = "条带数必须为正";
+        return -1;
+    }
+    if (cfg.shrink_batch < 1) {
+        err = "--shrink-batch 必须为正";
+        return -1;
+    }
+    if (cfg.disk_num_origin < cfg.n || cfg.disk_num_after_scale < cfg.n) {
+        err = "节点数不能小于条带长度";
+        return -1;
+    }
+    if (cfg.disk_num_origin > g_MaxDiskNum || cfg.disk_num_after_scale > g_MaxDiskNum) {
+        err = "节点数超过g_MaxDiskNum";
+        return -1;
+    }
+    if (cfg.stripe_num > g_MaxEdgeCount) {
+        err = "条带数超过邻接矩阵计数器的上限，请使用32位计数器编译";
+        return -1;
+    }
+    if (cfg.recovery && cfg.recovery_disk >= min(cfg.disk_num_origin, cfg.disk_num_after_scale)) {
+        err = "故障节点必须在扩缩容前后都存在";
+        return -1;
+    }
+    //直接重分布按统一的最大边数判断交换是否有效，不考虑节点配置中各节点对不同的上限
+    if (cfg.weighted_disks && cfg.redistribute == REDIST_SWAP && cfg.disk_num_origin == cfg.disk_num_after_scale) {
+        err = "直接重分布（--redistribute swap）不支持--disk-profile";
+        return -1;
+    }
+    long long total_block_num = cfg.TotalBlocks();
+    //各节点的块列表与块在列表中的下标都用int表示
+    if (total_block_num / cfg.MinDiskNum() > INT_MAX) {
+        err = "单个节点的块数超过int的范围";
+        return -1;
+    }
+    //按容量分配块数时不要求整除。布局文件中的实际布局不一定均匀，只免除扩缩容前节点数的检查，
+    //扩缩容后各节点的块数由模拟器决定，扩缩容后的节点数必须始终能整除总块数
+    bool origin_uneven = !cfg.external_layout && (total_block_num % cfg.disk_num_origin != 0);
+    bool target_uneven = total_block_num % cfg.disk_num_after_scale != 0;
+    if (!cfg.weighted_disks && (origin_uneven || target_uneven)) {
+        err = "无法保证各节点中块数相同";
+        return -1;
+    }
+    return 0;
+}
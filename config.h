@@ -0,0 +1,107 @@
+/*********************************************************************************
+  * FileName:  config.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  运行时配置，替代原先写死在main.h中的全局常量
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_CONFIG_H
+#define SUD_SCALE_SIMULATION_CONFIG_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+const int g_MaxDiskNum = 10000;
+
+/*节点数不变时的重分布方式*/
+enum RedistributeMode {
+    REDIST_VIRTUAL,     //虚拟扩容到能整除总块数的节点数后再缩容回来（原实现）
+    REDIST_SWAP         //在现有节点之间交换块，直接降低邻接矩阵的最大值
+};
+
+/*缩容时选择目标节点的方式*/
+enum ShrinkMode {
+    SHRINK_FIRST_FIT,   //逐块取第一个不超过理论最优解的节点（原实现）
+    SHRINK_FLOW         //每批块按最小费用流整体分配
+};
+
+/*输出详细程度*/
+enum Verbosity {
+    VERBOSE_QUIET,      //只输出一行汇总
+    VERBOSE_SUMMARY,    //输出理想最优解、是否达到最优解等结论
+    VERBOSE_FULL        //另外输出每次迁移与邻接矩阵（原实现的输出）
+};
+
+/*
+ * disk_num_origin小于disk_num_after_scale时执行扩容操作
+ * disk_num_origin大于disk_num_after_scale时执行缩容操作
+ * disk_num_origin等于disk_num_after_scale时执行数据重分布操作
+ */
+struct SimConfig {
+    int disk_num_origin = 12;
+    int disk_num_after_scale = 8;
+    int stripe_num = 6000;
+    int n = 4;
+    int k = 3;
+    int debug = 0;      //是否开启调试模式
+    int evaluation = 0;
+    int verbose = VERBOSE_FULL;     //输出详细程度，批量运行时为VERBOSE_QUIET
+    int placement = 0;  //InitDisks后期放置策略：0为最小堆，1为逐条带排序（原实现）
+    int triangular_graph = 0;   //邻接矩阵是否只存储上三角部分
+    unsigned long long seed = 0;    //随机数种子，0表示使用当前时间
+    int plan_threads = 0;       //扩容时并行规划每轮迁移的线程数，不大于1时逐节点串行规划
+    int recovery = 0;           //是否在扩缩容前后分析单节点故障的恢复读负载
+    int recovery_disk = -1;     //故障节点，-1表示分别分析每个节点故障
+    int recovery_threads = 0;   //故障分析的线程数，0表示使用全部核心
+    int external_layout = 0;    //初始布局是否来自布局文件
+    int weighted_disks = 0;     //是否按节点配置文件中的容量分配块数，此时不要求块数能被节点数整除
+    int redistribute = REDIST_VIRTUAL;  //重分布方式，见RedistributeMode
+    int shrink = SHRINK_FIRST_FIT;      //缩容时选择目标节点的方式，见ShrinkMode
+    int shrink_batch = 64;      //按批缩容时每批的块数
+    vector<int> timeline;       //非空时从disk_num_origin出发依次扩缩容到其中的各个节点数，忽略disk_num_after_scale
+
+    int Optimal() const;
+    int MinDiskNum() const;
+    int MaxDiskNum() const;
+    long long TotalBlocks() const { return (long long)n * stripe_num; }
+    int VirtualDiskNum() const;
+};
+
+/*网络模拟参数，所有节点使用相同的带宽*/
+struct NetConfig {
+    double nic_bw = 1250;   //网卡带宽，MB/s
+    double disk_bw = 200;   //磁盘带宽，MB/s
+    double block_mb = 64;   //块大小，MB
+    int streams = 1;        //每个节点同时进行的发送迁移数与接收迁移数
+    int top_links = 5;      //输出占用时间最长的链路数
+};
+
+/*命令行解析结果*/
+struct CliOptions {
+    SimConfig base;         //单次运行的配置，同时作为扫参文件中缺省项的默认值
+    string sweep_file;      //非空时按扫参文件批量运行
+    string output_file;     //批量运行结果输出文件，为空时输出到标准输出
+    string plan_file;       //非空时把迁移计划写入该文件
+    int plan_format = 0;    //迁移计划格式，见PlanFormat
+    string matrix_file;     //非空时把扩缩容后的邻接矩阵以二进制写入该文件
+    string layout_file;     //非空时从该二进制布局文件载入初始布局
+    string profile_file;    //非空时从该文件读取各节点的容量与带宽权重
+    string topology_file;   //非空时从该文件读取各节点所在的主机与机架
+    string convert_layout;  //非空时把该文本布局转换为二进制布局文件（写入output_file）后退出
+    string stats_file;      //非空时把计数器与阶段耗时以JSON写入该文件，"-"表示标准输出，扫参时每组参数一行
+    int netsim = 0;         //是否对迁移计划进行网络模拟
+    int redistribute_compare = 0;   //重分布时是否从同一初始布局分别执行两种方式并对比
+    NetConfig net;
+    int simd_level = -1;        //指定使用的指令集，-1表示使用CPU支持的最高级别
+    int trials = 0;             //大于0时执行多线程蒙特卡洛评估
+    int threads = 0;            //蒙特卡洛评估的线程数，0表示使用全部核心
+};
+
+int ParseArgs(int argc, char **argv, CliOptions &opts);
+int ParseInt(const char *s, int &value);
+int LoadSweepFile(const string &path, const SimConfig &base, vector<SimConfig> &configs);
+int ValidateConfig(const SimConfig &cfg, string &err);
+void PrintUsage(const char *prog);
+
+#endif //SUD_SCALE_SIMULATION_CONFIG_H
@@ -0,0 +1,93 @@
+/*********************************************************************************
+  * FileName:  diskprofile.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  异构节点的容量与带宽权重，决定每个节点应存放的块数与按时间计算的恢复瓶颈
+**********************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <math.h>
+#include "diskprofile.h"
+#include "config.h"
+
+using namespace std;
+
+int DiskProfile::Load(const string &path, string &err) {
+    ifstream in(path);
+    if (!in) {
+        err = "无法打开节点配置文件 " + path;
+        return -1;
+    }
+    capacity.clear();
+    bandwidth.clear();
+    string line;
+    int line_no = 0;
+    while (getline(in, line)) {
+        line_no++;
+        size_t pos = line.find('#');
+        if (pos != string::npos) line.erase(pos);
+        istringstream iss(line);
+        string range;
+        if (!(iss >> range)) continue;      //空行
+        int first, last;
+        char dash;
+        istringstream rs(range);
+        if (!(rs >> first)) first = -1;
+        last = first;
+        if (rs >> dash && (dash != '-' || !(rs >> last))) first = -1;
+        double cap, bw;
+        if (first < 0 || last < first || last >= g_MaxDiskNum || !(iss >> cap >> bw) || !(cap > 0) || !(bw > 0)) {
+            err = "节点配置文件第" + to_string(line_no) + "行格式错误，应为: first[-last] capacity bandwidth";
+            return -1;
+        }
+        if (capacity.size() <= last) {
+            capacity.resize(last + 1, 1);
+            bandwidth.resize(last + 1, 1);
+        }
+        for (int i = first; i <= last; i++) {
+            capacity[i] = cap;
+            bandwidth[i] = bw;
+        }
+    }
+    return 0;
+}
+
+void DiskProfile::Quotas(int disk_num, long long total, vector<int> &quota) const {
+    double sum = 0;
+    for (int i = 0; i < disk_num; i++) sum += Capacity(i);
+    quota.resize(disk_num);
+    //先取整数部分，剩下的块按小数部分从大到小逐个分配，小数部分相同时节点号小的优先
+    vector<pair<double, int> > remainder(disk_num);
+    long long assigned = 0;
+    for (int i = 0; i < disk_num; i++) {
+        double exact = total * Capacity(i) / sum;
+        quota[i] = (int)floor(exact);
+        assigned += quota[i];
+        remainder[i] = make_pair(-(exact - quota[i]), i);
+    }
+    sort(remainder.begin(), remainder.end());
+    for (int i = 0; assigned < total; i = (i + 1) % disk_num) {
+        quota[remainder[i].second]++;
+        assigned++;
+    }
+}
+
+double DiskProfile::OptimalTime(int disk_num, int k, const vector<int> &quota) const {
+    double bw_sum = 0;
+    for (int i = 0; i < disk_num; i++) bw_sum += Bandwidth(i);
+    double best = 0;
+    for (int a = 0; a < disk_num; a++) {
+        best = max(best, (double)k * quota[a] / (bw_sum - Bandwidth(a)));
+    }
+    return best;
+}
+
+void DiskProfile::EdgeLimits(int disk_num, double optimal_time, vector<int> &limit) const {
+    limit.resize(disk_num);
+    for (int i = 0; i < disk_num; i++) {
+        //加上一个很小的量，避免optimal_time*bw_a恰好为整数时因舍入误差少算1
+        limit[i] = (int)floor(optimal_time * Bandwidth(i) + 1e-9) + 1;
+    }
+}
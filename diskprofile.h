@@ -0,0 +1,51 @@
+/*********************************************************************************
+  * FileName:  diskprofile.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  异构节点的容量与带宽权重，决定每个节点应存放的块数与按时间计算的恢复瓶颈
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_DISKPROFILE_H
+#define SUD_SCALE_SIMULATION_DISKPROFILE_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+ * 每个节点的容量与带宽权重，未指定的节点均为1。容量只按比例使用：扩缩容前后各节点应存放的块数与容量成正比。
+ * 带宽为相对值：节点a故障时从节点b读取G[a][b]个块，反之亦然，因此节点对(a, b)的恢复时间按
+ * G[a][b] / min(bw_a, bw_b)计算，单位为带宽为1的节点传输一块的时间
+ */
+class DiskProfile {
+public:
+    /**
+     * @brief   读取节点配置文件。每个非空、非#开头的行为: first[-last] capacity bandwidth，
+                表示节点first到last（含）的容量与带宽，两者都必须为正
+     * @return  成功返回0，失败返回-1并在err中给出原因
+     */
+    int Load(const string &path, string &err);
+
+    double Capacity(int disk) const { return disk < capacity.size() ? capacity[disk] : 1; }
+    double Bandwidth(int disk) const { return disk < bandwidth.size() ? bandwidth[disk] : 1; }
+
+    /**
+     * @brief   把total个块按容量比例分给前disk_num个节点，按最大余数法取整，各节点块数之和恰好为total
+     */
+    void Quotas(int disk_num, long long total, vector<int> &quota) const;
+    /**
+     * @brief   理想的恢复时间：节点a故障时需要读取k*quota[a]个块，由其余节点按带宽比例分担，取各节点中的最大值
+     */
+    double OptimalTime(int disk_num, int k, const vector<int> &quota) const;
+    /**
+     * @brief   每个节点的边数上限limit[a] = floor(optimal_time * bw_a) + 1，节点对(a, b)的上限为
+                min(limit[a], limit[b])。带宽全为1时与SimConfig::Optimal相同
+     */
+    void EdgeLimits(int disk_num, double optimal_time, vector<int> &limit) const;
+
+private:
+    vector<double> capacity;
+    vector<double> bandwidth;
+};
+
+#endif //SUD_SCALE_SIMULATION_DISKPROFILE_H
@@ -0,0 +1,87 @@
+/*********************************************************************************
+  * FileName:  graph.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  按实际节点数分配的邻接矩阵
+**********************************************************************************/
+
+#include <stdio.h>
+#include <algorithm>
+#include "graph.h"
+#include "simd.h"
+
+using namespace std;
+
+void AdjacencyMatrix::Reset(int new_disk_num, int use_triangular) {
+    disk_num = new_disk_num;
+    triangular = use_triangular;
+    size_t size = triangular ? (size_t)disk_num * (disk_num - 1) / 2 : (size_t)disk_num * disk_num;
+    //assign只在容量不足时重新分配
+    data.assign(size, 0);
+}
+
+void AdjacencyMatrix::Grow(int new_disk_num) {
+    if (new_disk_num <= disk_num) return;
+    if (triangular) {
+        //三角存储中已有元素的位置与节点数无关，直接在尾部追加
+        data.resize((size_t)new_disk_num * (new_disk_num - 1) / 2, 0);
+    } else {
+        //完整存储的行宽改变，从最后一行开始向后搬移，避免覆盖尚未搬移的数据
+        data.resize((size_t)new_disk_num * new_disk_num, 0);
+        for (int i = disk_num - 1; i >= 0; i--) {
+            edge_t *src = &data[(size_t)i * disk_num];
+            edge_t *dst = &data[(size_t)i * new_disk_num];
+            copy_backward(src, src + disk_num, dst + disk_num);
+            fill(dst + disk_num, dst + new_disk_num, 0);
+        }
+    }
+    disk_num = new_disk_num;
+}
+
+edge_t AdjacencyMatrix::RowArgMax(int i, int len, int &arg) const {
+    edge_t best = 0;
+    arg = 0;
+    if (triangular) {
+        for (int j = 0; j < len; j++) {
+            edge_t v = Get(i, j);
+            if (v > best) {
+                best = v;
+                arg = j;
+            }
+        }
+        return best;
+    }
+    return RowArgMaxKernel(Row(i), len, arg);
+}
+
+bool AdjacencyMatrix::AnyAtLeast(int i, const int *cols, int count, int skip, long long limit) const {
+    if (limit > g_MaxEdgeCount) return false;
+    if (triangular) {
+        for (int m = 0; m < count; m++) {
+            if (cols[m] == skip) continue;
+            if (Get(i, cols[m]) >= limit) return true;
+        }
+        return false;
+    }
+    return AnyAtLeastKernel(Row(i), cols, count, skip, (edge_t)limit);
+}
+
+int AdjacencyMatrix::DumpBinary(const string &path, int len) const {
+    static const char magic[8] = {'S', 'U', 'D', 'G', 'M', 'A', 'T', '\0'};
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return -1;
+    uint32_t header[3] = {1, (uint32_t)len, (uint32_t)sizeof(edge_t)};
+    int ok = fwrite(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+             fwrite(header, sizeof(uint32_t), 3, file) == 3;
+    vector<edge_t> row(len);
+    for (int i = 0; i < len && ok; i++) {
+        if (triangular) {
+            for (int j = 0; j < len; j++) row[j] = Get(i, j);
+            ok = fwrite(row.data(), sizeof(edge_t), len, file) == (size_t)len;
+        } else {
+            ok = fwrite(Row(i), sizeof(edge_t), len, file) == (size_t)len;
+        }
+    }
+    if (fclose(file) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
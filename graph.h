@@ -0,0 +1,116 @@
+/*********************************************************************************
+  * FileName:  graph.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  按实际节点数分配的邻接矩阵，G[i][j]表示节点i与节点j之间的边数
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_GRAPH_H
+#define SUD_SCALE_SIMULATION_GRAPH_H
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+using namespace std;
+
+/*
+ * 边数计数器的宽度。一个条带对某对节点之间的边数最多贡献1，因此边数不会超过条带数，
+ * 条带数不超过65535时可以用SUD_EDGE_COUNTER_16编译出16位计数器，内存减半
+ */
+#ifdef SUD_EDGE_COUNTER_16
+typedef uint16_t edge_t;
+const long long g_MaxEdgeCount = 65535;
+#else
+typedef uint32_t edge_t;
+const long long g_MaxEdgeCount = 4294967295LL;
+#endif
+
+/*
+ * 邻接矩阵有两种存储方式：
+ * 完整存储：disk_num*disk_num个计数器，每行连续存放，按行扫描时访问连续内存
+ * 三角存储：邻接矩阵是对称的且对角线恒为0，只存储i<j的部分，(i, j)位于j*(j-1)/2+i，
+ *          内存约为完整存储的一半，且扩大节点数时已有的数据位置不变
+ */
+class AdjacencyMatrix {
+public:
+    AdjacencyMatrix() : disk_num(0), triangular(0) {}
+
+    /**
+     * @brief   重新设置节点数与存储方式并清零，已分配的内存会被复用
+     */
+    void Reset(int new_disk_num, int use_triangular);
+    /**
+     * @brief   扩大节点数，保留已有的边数，新增的行列为0
+     */
+    void Grow(int new_disk_num);
+    /**
+     * @brief   求第i行前len列中的最大值及其所在列，最大值相同时取列号最小的
+     */
+    edge_t RowArgMax(int i, int len, int &arg) const;
+    /**
+     * @brief   第i行中cols[0..count)列（跳过等于skip的列）是否存在边数不小于limit的元素
+     */
+    bool AnyAtLeast(int i, const int *cols, int count, int skip, long long limit) const;
+    /**
+     * @brief   列数N在编译期已知时的AnyAtLeast。少于8列时AVX2内核本来也会退回标量实现，
+                这里直接展开为N次无分支的比较，省去一次间接调用；8列及以上仍使用向量化内核
+     */
+    template <int N>
+    bool AnyAtLeastFixed(int i, const int *cols, int skip, long long limit) const {
+        if (N >= 8 || triangular) return AnyAtLeast(i, cols, N, skip, limit);
+        if (limit > g_MaxEdgeCount) return false;
+        const edge_t *row = Row(i);
+        bool hit = false;
+        for (int m = 0; m < N; m++) {
+            hit |= (cols[m] != skip) & (row[cols[m]] >= (edge_t)limit);
+        }
+        return hit;
+    }
+
+    /**
+     * @brief   把前len个节点构成的子矩阵按行完整写入二进制文件。格式为8字节魔数"SUDGMAT"、
+                uint32版本号、uint32节点数、uint32计数器字节数，之后是len*len个计数器，
+                均按本机字节序写入（x86上为小端）
+     * @return  成功返回0，失败返回-1
+     */
+    int DumpBinary(const string &path, int len) const;
+
+    int Size() const { return disk_num; }
+    int IsTriangular() const { return triangular; }
+    size_t MemoryBytes() const { return data.capacity() * sizeof(edge_t); }
+    /**
+     * @brief   第i行的起始地址，只能用于完整存储
+     */
+    const edge_t *Row(int i) const { return &data[(size_t)i * disk_num]; }
+
+    edge_t Get(int i, int j) const {
+        if (triangular) {
+            if (i == j) return 0;
+            return i < j ? data[TriIndex(i, j)] : data[TriIndex(j, i)];
+        }
+        return data[(size_t)i * disk_num + j];
+    }
+
+    /**
+     * @brief   将节点i与节点j之间的边数增加delta，同时维护对称位置
+     */
+    void Add(int i, int j, int delta) {
+        if (triangular) {
+            data[i < j ? TriIndex(i, j) : TriIndex(j, i)] += delta;
+        } else {
+            data[(size_t)i * disk_num + j] += delta;
+            data[(size_t)j * disk_num + i] += delta;
+        }
+    }
+
+private:
+    static size_t TriIndex(int i, int j) {
+        return (size_t)j * (j - 1) / 2 + i;
+    }
+
+    int disk_num;
+    int triangular;
+    vector<edge_t> data;
+};
+
+#endif //SUD_SCALE_SIMULATION_GRAPH_H
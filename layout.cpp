@@ -0,0 +1,101 @@
+/*********************************************************************************
+  * FileName:  layout.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  数据布局：每个条带的块分别位于哪些节点
+**********************************************************************************/
+
+#include <algorithm>
+#include "layout.h"
+
+using namespace std;
+
+void StripeTable::Reset(int new_stripe_num, int new_width, int new_disk_num) {
+    stripe_num = new_stripe_num;
+    width = new_width;
+    //assign只在容量不足时重新分配
+    location.assign((size_t)stripe_num * width, -1);
+    loc = location.data();
+    position.assign((size_t)stripe_num * width, -1);
+    disk_num = 0;
+    mask_words = 0;
+    GrowDisks(new_disk_num);
+}
+
+void StripeTable::Attach(int *data, int new_stripe_num, int new_width, int new_disk_num) {
+    stripe_num = new_stripe_num;
+    width = new_width;
+    loc = data;
+    //不再使用自有存储，释放之前Reset分配的内存
+    vector<int>().swap(location);
+    position.assign((size_t)stripe_num * width, -1);
+    //节点位图按外部数组中的布局重建
+    disk_num = 0;
+    mask_words = 0;
+    GrowDisks(new_disk_num);
+}
+
+void StripeTable::GrowDisks(int new_disk_num) {
+    if (new_disk_num <= disk_num) return;
+    disk_num = new_disk_num;
+    int words = (disk_num + 63) / 64;
+    if (words > g_MaxMaskWords) words = 0;
+    if (words == mask_words) return;
+    mask_words = words;
+    if (mask_words == 0) return;
+    mask.assign((size_t)stripe_num * mask_words, 0);
+    for (int s = 0; s < stripe_num; s++) {
+        const int *members = Members(s);
+        uint64_t *row = &mask[(size_t)s * mask_words];
+        for (int i = 0; i < width; i++) {
+            if (members[i] >= 0) row[members[i] >> 6] |= 1ULL << (members[i] & 63);
+        }
+    }
+}
+
+void ListArena::Reset() {
+    used = 0;
+    base.clear();
+    count.clear();
+    cap.clear();
+}
+
+int ListArena::AddList(int capacity) {
+    capacity = capacity > 0 ? capacity : 1;
+    base.push_back(Allocate(capacity));
+    count.push_back(0);
+    cap.push_back(capacity);
+    return count.size() - 1;
+}
+
+/**
+ * @brief   从arena末尾分配size个位置，arena不足时扩大，已有数据的位置不变
+ */
+size_t ListArena::Allocate(int size) {
+    size_t start = used;
+    used += size;
+    if (used > arena.size()) {
+        arena.resize(max(used, arena.size() * 2));
+    }
+    return start;
+}
+
+void ListArena::Relocate(int list) {
+    int new_cap = cap[list] * 2;
+    size_t new_base = Allocate(new_cap);
+    copy(arena.begin() + base[list], arena.begin() + base[list] + count[list], arena.begin() + new_base);
+    base[list] = new_base;
+    cap[list] = new_cap;
+}
+
+void DiskBlockSet::Reset(int new_disk_num, int disk_capacity) {
+    capacity = disk_capacity;
+    lists.Reset();
+    Grow(new_disk_num);
+}
+
+void DiskBlockSet::Grow(int new_disk_num) {
+    while (lists.ListNum() < new_disk_num) {
+        lists.AddList(capacity);
+    }
+}
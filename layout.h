@@ -0,0 +1,214 @@
+/*********************************************************************************
+  * FileName:  layout.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  数据布局：每个条带的块分别位于哪些节点
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_LAYOUT_H
+#define SUD_SCALE_SIMULATION_LAYOUT_H
+
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+/*
+ * 每个条带的节点位图最多占用的64位字数。节点数不超过64时每个条带只需一个字，
+ * 不超过128时两个字；节点数更多时位图按需加长，超过该上限后位图比逐个比较条带成员更费内存，
+ * 此时不再使用位图
+ */
+const int g_MaxMaskWords = 16;
+
+/*
+ * 按条带号索引的定长表。条带号是0..stripe_num-1的连续整数，每个条带恰好有n个块，
+ * 因此所有条带的块位置连续存放在一个数组中，第s个条带占用[s*n, s*n+n)。
+ * 条带的各项属性分别存放在独立的数组中（结构体数组转为数组结构体），
+ * 查询不需要哈希，也不需要为每个条带单独分配内存
+ */
+class StripeTable {
+public:
+    StripeTable() : stripe_num(0), width(0), loc(nullptr), disk_num(0), mask_words(0) {}
+
+    /**
+     * @brief   重新设置条带数、条带长度与节点数，所有位置置为-1，已分配的内存会被复用
+     */
+    void Reset(int new_stripe_num, int new_width, int new_disk_num);
+    /**
+     * @brief   直接使用外部的location数组（例如映射的布局文件），不复制。data由调用者持有，
+                在下一次Reset或Attach之前必须保持有效，迁移会原地修改其中的内容
+     */
+    void Attach(int *data, int new_stripe_num, int new_width, int new_disk_num);
+    /**
+     * @brief   扩大节点编号的范围，必要时按当前布局重建节点位图
+     */
+    void GrowDisks(int new_disk_num);
+
+    int StripeNum() const { return stripe_num; }
+    int Width() const { return width; }
+
+    /**
+     * @brief   第s个条带各个块所在的节点，共Width()个
+     */
+    const int *Members(int s) const { return loc + (size_t)s * width; }
+
+    void Set(int s, int slot, int disk) {
+        int &cell = loc[(size_t)s * width + slot];
+        if (mask_words > 0) {
+            uint64_t *words = &mask[(size_t)s * mask_words];
+            if (cell >= 0) words[cell >> 6] &= ~(1ULL << (cell & 63));
+            words[disk >> 6] |= 1ULL << (disk & 63);
+        }
+        cell = disk;
+    }
+
+    /**
+     * @brief   返回disk在第s个条带中的槽位，不存在时返回-1
+     */
+    int Find(int s, int disk) const {
+        const int *members = Members(s);
+        for (int i = 0; i < width; i++) {
+            if (members[i] == disk) return i;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief   第s个条带是否有块位于disk，使用位图时只需一次位测试
+     */
+    bool Contains(int s, int disk) const {
+        if (mask_words > 0) {
+            return (mask[(size_t)s * mask_words + (disk >> 6)] >> (disk & 63)) & 1;
+        }
+        return Find(s, disk) != -1;
+    }
+
+    /**
+     * @brief   块迁移时原地把第s个条带中的old_disk替换为new_disk
+     */
+    void Replace(int s, int old_disk, int new_disk) { Set(s, Find(s, old_disk), new_disk); }
+
+    /**
+     * @brief   第s个条带第slot个块在其所在节点块列表中的下标，由DiskBlockSet维护
+     */
+    int Position(int s, int slot) const { return position[(size_t)s * width + slot]; }
+    void SetPosition(int s, int slot, int pos) { position[(size_t)s * width + slot] = pos; }
+
+private:
+    int stripe_num;
+    int width;
+    vector<int> location;   //Reset时使用的自有存储
+    int *loc;               //loc[s*width+i]为第s个条带第i个块所在的节点，指向location或Attach的外部数组
+    vector<int> position;   //position[s*width+i]为该块在节点块列表中的下标
+    int disk_num;
+    int mask_words;         //每个条带的位图占用的字数，为0时不使用位图
+    vector<uint64_t> mask;  //mask[s*mask_words+w]的第b位表示第s个条带是否有块位于节点w*64+b
+};
+
+/*节点块列表的只读视图，接口与vector<int>的只读部分一致*/
+class BlockList {
+public:
+    BlockList(const int *data, int count) : data(data), count(count) {}
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int back() const { return data[count - 1]; }
+    int operator[](int i) const { return data[i]; }
+    const int *begin() const { return data; }
+    const int *end() const { return data + count; }
+
+private:
+    const int *data;
+    int count;
+};
+
+/*
+ * 在同一块arena中存放多个可增长的int列表。每个列表占用一段固定容量的区间，超出容量时
+ * 把列表搬到arena末尾并加倍容量，原区间直到Reset才回收（单调分配）。Reset只把分配位置归零，
+ * arena与各数组的内存在多次运行之间复用，达到过的最大规模之内不再分配内存
+ */
+class ListArena {
+public:
+    ListArena() : used(0) {}
+
+    /**
+     * @brief   删除所有列表，保留已分配的内存
+     */
+    void Reset();
+    /**
+     * @brief   新建一个预留capacity个位置的空列表
+     * @return  列表编号，从0开始连续分配
+     */
+    int AddList(int capacity);
+
+    int ListNum() const { return count.size(); }
+    int Size(int list) const { return count[list]; }
+    BlockList View(int list) const { return BlockList(arena.data() + base[list], count[list]); }
+    int *Data(int list) { return arena.data() + base[list]; }
+
+    void PushBack(int list, int value) {
+        if (count[list] == cap[list]) Relocate(list);
+        arena[base[list] + count[list]++] = value;
+    }
+    void PopBack(int list) { count[list]--; }
+
+private:
+    size_t Allocate(int size);
+    void Relocate(int list);
+
+    vector<int> arena;      //所有列表的数据，只增不减
+    size_t used;            //arena中已分配的长度
+    vector<size_t> base;    //每个列表在arena中的起始位置
+    vector<int> count;      //每个列表的长度
+    vector<int> cap;        //每个列表的区间长度
+};
+
+/*
+ * 每个节点中存储的块（以条带号表示），每个节点对应ListArena中的一个列表。
+ * 块在列表中的下标记录在StripeTable中，删除时用列表末尾的块填补空位，
+ * 因此插入与删除都是O(1)，列表中块的顺序不固定
+ */
+class DiskBlockSet {
+public:
+    DiskBlockSet() : capacity(1) {}
+
+    /**
+     * @brief   清空所有节点并设置节点数，已分配的内存会被复用
+     * @param   disk_capacity   每个节点预留的块数，取运行过程中单个节点的最大块数时不需要搬移
+     */
+    void Reset(int new_disk_num, int disk_capacity);
+    /**
+     * @brief   扩大节点数，新增的节点为空，预留的块数与Reset时相同
+     */
+    void Grow(int new_disk_num);
+
+    int DiskNum() const { return lists.ListNum(); }
+    BlockList operator[](int disk) const { return lists.View(disk); }
+
+    /**
+     * @brief   把条带stripe中位于第slot个槽位的块加入disk
+     */
+    void Insert(int disk, int stripe, int slot, StripeTable &table) {
+        table.SetPosition(stripe, slot, lists.Size(disk));
+        lists.PushBack(disk, stripe);
+    }
+
+    /**
+     * @brief   把条带stripe中位于第slot个槽位的块从disk中删除，用末尾的块填补空位
+     */
+    void Remove(int disk, int stripe, int slot, StripeTable &table) {
+        int *list = lists.Data(disk);
+        int pos = table.Position(stripe, slot);
+        int last = list[lists.Size(disk) - 1];
+        if (last != stripe) {
+            list[pos] = last;
+            table.SetPosition(last, table.Find(last, disk), pos);
+        }
+        lists.PopBack(disk);
+    }
+
+private:
+    int capacity;           //新节点预留的块数
+    ListArena lists;
+};
+
+#endif //SUD_SCALE_SIMULATION_LAYOUT_H
@@ -0,0 +1,223 @@
+/*********************************************************************************
+  * FileName:  layoutfile.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  实际集群的布局文件：从文本导出转换为二进制格式，运行时通过mmap直接使用
+**********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vector>
+#include "layoutfile.h"
+
+using namespace std;
+
+static const char g_LayoutMagic[8] = {'S', 'U', 'D', 'L', 'A', 'Y', 'T', '\0'};
+static const uint32_t g_LayoutVersion = 1;
+static const uint32_t g_MaxLayoutWidth = 65535;    //条带长度的上限，保证文件长度的计算不会溢出
+
+LayoutFile::LayoutFile() : fd(-1), length(0), addr(nullptr) {
+    memset(&header, 0, sizeof(header));
+}
+
+LayoutFile::~LayoutFile() {
+    Close();
+}
+
+int LayoutFile::Open(const string &path, string &err) {
+    Close();
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        err = "无法打开布局文件 " + path;
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header)
+        || memcmp(header.magic, g_LayoutMagic, sizeof(g_LayoutMagic)) != 0) {
+        err = path + " 不是布局文件";
+        Close();
+        return -1;
+    }
+    if (header.version != g_LayoutVersion) {
+        err = path + " 的版本不受支持";
+        Close();
+        return -1;
+    }
+    length = st.st_size;
+    uint64_t expected = sizeof(header) + header.stripe_num * header.width * sizeof(int32_t);
+    if (header.width < 2 || header.width > g_MaxLayoutWidth || header.stripe_num == 0
+        || header.stripe_num > 0x7fffffffULL || header.disk_num == 0 || length != expected) {
+        err = path + " 的文件头与文件长度不符";
+        Close();
+        return -1;
+    }
+    //先映射一次，确认之后每次Map都能成功
+    const int *data = Map();
+    if (data == nullptr) {
+        err = "无法映射布局文件 " + path;
+        Close();
+        return -1;
+    }
+    //映射的数组会直接用作各节点块列表、邻接矩阵与节点位图的下标，使用前逐个检查
+    if (Validate(data, err) != 0) {
+        err = path + "：" + err;
+        Close();
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   检查每个块所在的节点号都在[0, disk_num)内，且同一条带中没有重复的节点
+ */
+int LayoutFile::Validate(const int *data, string &err) const {
+    int width = header.width;
+    for (uint64_t s = 0; s < header.stripe_num; s++) {
+        const int *members = data + s * width;
+        for (int i = 0; i < width; i++) {
+            if (members[i] < 0 || (uint32_t)members[i] >= header.disk_num) {
+                err = "条带" + to_string(s) + "中的节点号" + to_string(members[i]) + "超出范围";
+                return -1;
+            }
+            for (int j = 0; j < i; j++) {
+                if (members[j] == members[i]) {
+                    err = "条带" + to_string(s) + "中节点" + to_string(members[i]) + "出现了多次";
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int *LayoutFile::Map() {
+    Unmap();
+    if (fd < 0) return nullptr;
+    //映射整个文件，数据紧跟在32字节的文件头之后，int32对齐
+    void *p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return nullptr;
+    addr = p;
+    return (int *)((char *)addr + sizeof(header));
+}
+
+void LayoutFile::Unmap() {
+    if (addr != nullptr) {
+        munmap(addr, length);
+        addr = nullptr;
+    }
+}
+
+void LayoutFile::Close() {
+    Unmap();
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+int ConvertLayout(const string &text_path, const string &out_path, LayoutHeader &header, string &err) {
+    FILE *in = fopen(text_path.c_str(), "r");
+    if (in == nullptr) {
+        err = "无法打开文本布局 " + text_path;
+        return -1;
+    }
+    FILE *out = fopen(out_path.c_str(), "wb");
+    if (out == nullptr) {
+        fclose(in);
+        err = "无法打开输出文件 " + out_path;
+        return -1;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, g_LayoutMagic, sizeof(g_LayoutMagic));
+    header.version = g_LayoutVersion;
+    int ret = 0;
+    //先写入占位的文件头，转换完成后再写入条带数与节点数
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+        err = "写入输出文件失败";
+        ret = -1;
+    }
+    vector<int32_t> buffer;
+    buffer.reserve(1 << 20);
+    vector<int32_t> members;
+    char *line = nullptr;
+    size_t cap = 0;
+    long long line_no = 0;
+    int32_t max_disk = -1;
+    while (ret == 0 && getline(&line, &cap, in) != -1) {
+        line_no++;
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+        members.clear();
+        while (true) {
+            char *end;
+            long disk = strtol(p, &end, 10);
+            if (end == p) break;
+            if (disk < 0 || disk > 0x7fffffffL) {
+                err = "第" + to_string(line_no) + "行的节点号不合法";
+                ret = -1;
+                break;
+            }
+            members.push_back((int32_t)disk);
+            p = end;
+        }
+        if (ret != 0) break;
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+        if (*p != '\0' && *p != '#') {
+            err = "第" + to_string(line_no) + "行含有非数字内容";
+            ret = -1;
+            break;
+        }
+        if (header.width == 0) header.width = members.size();
+        if (members.size() != header.width || header.width < 2 || header.width > g_MaxLayoutWidth) {
+            err = "第" + to_string(line_no) + "行的块数与第一个条带不同、少于2或超过" + to_string(g_MaxLayoutWidth);
+            ret = -1;
+            break;
+        }
+        for (int i = 0; i < members.size(); i++) {
+            for (int j = i + 1; j < members.size(); j++) {
+                if (members[i] == members[j]) {
+                    err = "第" + to_string(line_no) + "行中同一个节点出现了多次";
+                    ret = -1;
+                }
+            }
+            if (members[i] > max_disk) max_disk = members[i];
+        }
+        if (ret != 0) break;
+        buffer.insert(buffer.end(), members.begin(), members.end());
+        header.stripe_num++;
+        if (buffer.size() >= (1 << 20)) {
+            if (fwrite(buffer.data(), sizeof(int32_t), buffer.size(), out) != buffer.size()) {
+                err = "写入输出文件失败";
+                ret = -1;
+                break;
+            }
+            buffer.clear();
+        }
+    }
+    free(line);
+    fclose(in);
+    if (ret == 0 && header.stripe_num == 0) {
+        err = "文本布局中没有条带";
+        ret = -1;
+    }
+    if (ret == 0) {
+        header.disk_num = max_disk + 1;
+        if (fwrite(buffer.data(), sizeof(int32_t), buffer.size(), out) != buffer.size()
+            || fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1) {
+            err = "写入输出文件失败";
+            ret = -1;
+        }
+    }
+    if (fclose(out) != 0 && ret == 0) {
+        err = "写入输出文件失败";
+        ret = -1;
+    }
+    if (ret != 0) remove(out_path.c_str());
+    return ret;
+}
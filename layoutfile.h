@@ -0,0 +1,71 @@
+/*********************************************************************************
+  * FileName:  layoutfile.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  实际集群的布局文件：从文本导出转换为二进制格式，运行时通过mmap直接使用
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_LAYOUTFILE_H
+#define SUD_SCALE_SIMULATION_LAYOUTFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+using namespace std;
+
+/*
+ * 二进制布局文件由32字节的文件头与location数组组成。location[s*width+i]为第s个条带第i个块所在的节点，
+ * 为本机字节序的int32（x86上为小端），与StripeTable的内部表示相同，因此映射后不需要解析即可直接作为block_location使用
+ */
+struct LayoutHeader {
+    char magic[8];          //"SUDLAYT"
+    uint32_t version;
+    uint32_t width;         //条带长度n
+    uint64_t stripe_num;
+    uint32_t disk_num;
+    uint32_t reserved;
+};
+
+class LayoutFile {
+public:
+    LayoutFile();
+    ~LayoutFile();
+    LayoutFile(const LayoutFile &) = delete;
+    LayoutFile &operator=(const LayoutFile &) = delete;
+
+    /**
+     * @brief   打开布局文件，检查文件头、文件长度以及每个块所在的节点号（范围与条带内重复）
+     * @return  成功返回0，失败返回-1并在err中给出原因
+     */
+    int Open(const string &path, string &err);
+    /**
+     * @brief   以MAP_PRIVATE方式重新映射location数组。迁移对映射的修改只写入进程私有的页，
+                不会改变文件；每次重新映射都得到文件中的原始布局
+     * @return  映射的location数组，失败时返回nullptr
+     */
+    int *Map();
+    void Close();
+
+    bool IsOpen() const { return fd >= 0; }
+    const LayoutHeader &Header() const { return header; }
+
+private:
+    void Unmap();
+    int Validate(const int *data, string &err) const;
+
+    int fd;
+    LayoutHeader header;
+    size_t length;          //文件长度
+    void *addr;             //当前映射的起始地址，未映射时为nullptr
+};
+
+/**
+ * @brief   把文本导出转换为二进制布局文件。文本中每个非空、非#开头的行描述一个条带，按行号依次为条带0、1、...，
+            内容为以空白分隔的各个块所在的节点号，所有行的块数必须相同，同一条带中节点号不能重复。
+            转换时逐行流式写出，内存占用与条带数无关
+ * @param   header  成功时返回写入的文件头
+ * @return  成功返回0，失败返回-1并在err中给出原因
+ */
+int ConvertLayout(const string &text_path, const string &out_path, LayoutHeader &header, string &err);
+
+#endif //SUD_SCALE_SIMULATION_LAYOUTFILE_H
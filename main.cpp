@@ -6,485 +6,374 @@
 **********************************************************************************/
 
 #include <iostream>
-#include <algorithm>
+#include <fstream>
 #include <chrono>
-#include <random>
-#include <map>
-#include <assert.h>
-#include <math.h>
+#include <algorithm>
 #include "main.h"
+#include "montecarlo.h"
+#include "simd.h"
+#include "netsim.h"
+#include "layoutfile.h"
+#include "diskprofile.h"
+#include "topology.h"
 
 using namespace std;
 
-/*InitDisk中用于对节点中的块数排序*/
-bool cmp(pair<int, int> p1, pair<int, int> p2){
-    return p1.second < p2.second;
-}
-
 /**
- * @brief   随机生成节点中的数据。采用的方法为，首先通过shuffle随机选择g_N个节点存放
-            第一个条带。之后按照各个节点中存储的块数进行排序，选出块数最少的g_N个节点放置下一个条带。因为
-            g_N、条带长度、节点数之间满足整除关系，所以最终每个节点中的块数一定相同
- **/
-void InitDisks() {
-    vector<int> vec_temp;
-    for (int i = 0; i < g_DiskNumOrigin; i++) {
-        vec_temp.push_back(i);
-    }
-    for (int i = 0; i < g_DiskNumOrigin; i++) {
-        vector<int> disk;
-        disks.push_back(disk);
-    }
-    int cur_stripe_num = 0;
-    int quit_shuffle = 0;
-    while (true) {
-        //获取随机数种子
-        unsigned seed = chrono::system_clock::now().time_since_epoch().count();
-        shuffle(vec_temp.begin(), vec_temp.end(), default_random_engine(seed));
-        for (int i = 0; i < g_N; i++) {
-            int select = vec_temp[i];
-            disks[select].push_back(cur_stripe_num);
-            block_location[cur_stripe_num].push_back(select);
-            if (disks[select].size() >= g_N * g_StripeNum / g_DiskNumOrigin) {
-                quit_shuffle = 1;
-            }
-        }
-        cur_stripe_num++;
-        if (quit_shuffle == 1) break;
-    }
-    /*完成了前期的shuffle，接下来按照每个节点中块数升序排序。思路为构建vector<pair<节点号, 块数> >，
-    然后根据块数排序.这个方法时间复杂度较高，有待改进*/
-    vector<pair<int, int> > pii;
-    while (cur_stripe_num < g_StripeNum) {
-        for (int i = 0; i < g_DiskNumOrigin; i++) {
-            pii.push_back(make_pair(i, disks[i].size()));
-        }
-        sort(pii.begin(), pii.end(), cmp);
-        for (int i = 0; i < g_N; i++) {
-            disks[pii[i].first].push_back(cur_stripe_num);
-            block_location[cur_stripe_num].push_back(pii[i].first);
-        }
-        cur_stripe_num++;
-        pii.clear();
-    }
-    if (g_Debug == 1) {
-        cout << "===== InitDisks =====" << endl;
-        //测试
-        cout << "各节点中块数：" << endl;
-        for (int i = 0; i < g_DiskNumOrigin; i++) {
-            cout << disks[i].size() << " ";
-        }
-        cout << endl << endl;
-        cout << "各节点中的块号：" << endl;
-        for (int i = 0; i < g_DiskNumOrigin; i++) {
-            cout << "disk" << i << ": ";
-            for (int j = 0; j < disks[i].size(); j++) {
-                cout << disks[i][j] << " ";
-            }
-            cout << endl << endl;
-        }
-        //测试哈希表
-        cout << "测试哈希表：" << endl;
-        for (int i = 0; i < g_StripeNum; i++) {
-            cout << "stripe " << i << ": ";
-            for (int j = 0; j < block_location[i].size(); j++) {
-                cout << block_location[i][j] << " ";
-            }
-            cout << endl;
-        }
-
-        cout << "===== end =====" << endl << endl;
+ * @brief   打开--stats指定的文件，"-"表示标准输出
+ * @return  未指定时返回nullptr，无法打开时返回nullptr并把ok置为0
+ */
+static ostream *OpenStatsStream(const string &path, ofstream &file, int &ok) {
+    ok = 1;
+    if (path.empty()) return nullptr;
+    if (path == "-") return &cout;
+    file.open(path);
+    if (!file) {
+        cerr << "Error: 无法打开统计文件 " << path << endl;
+        ok = 0;
+        return nullptr;
     }
+    return &file;
 }
 
 /**
- * @brief   根据随机生成的数据初始化图
+ * @brief   输出时间线模式中每一步与累计的迁移块数及最大边数
  */
-void InitGraph() {
-    //根据block_location可以方便地知道哪些节点之间应该有边
-    for (int i = 0; i < g_StripeNum; i++) {
-        for (int j = 0; j < block_location[i].size() - 1; j++) {
-            for (int k = j + 1; k < block_location[i].size(); k++) {
-                G[block_location[i][j]][block_location[i][k]] ++;
-                G[block_location[i][k]][block_location[i][j]] ++;
-            }
-        }
-    }
-    if (g_Evaluation == 0)
-        cout << "根据随机数据生成的邻接矩阵：" << endl;
-    for (int i = 0; i < g_DiskNumOrigin; i++) {
-        for (int j = 0; j < g_DiskNumOrigin; j++) {
-            cout << G[i][j] << " ";
-        }
-        cout << endl;
+static void PrintTimeline(const vector<TimelineStep> &steps, const SimResult &res) {
+    cout << "===== 时间线 =====" << endl;
+    cout << "步骤\t节点数\t理想最优解\t最大边数\t迁移块数\t次优解\t累计迁移\t耗时(ms)" << endl;
+    int peak = 0;
+    for (int i = 0; i < steps.size(); i++) {
+        const TimelineStep &s = steps[i];
+        cout << i + 1 << "\t" << s.disk_num_before << "->" << s.disk_num_after << "\t" << s.optimal << "\t"
+             << s.max_edge << (s.is_optimal ? "" : "*") << "\t" << s.moved_blocks << "\t" << s.suboptimal_moves
+             << "\t" << s.total_moved_blocks << "\t" << s.elapsed_ms << endl;
+        peak = max(peak, s.max_edge);
     }
-    cout << endl;
+    cout << "共" << steps.size() << "步，累计迁移" << res.moved_blocks << "块，各步最大边数的峰值为" << peak
+         << "（*表示未能得到理想最优解）" << endl;
 }
 
 /**
- * @brief   从disk中选择一个将要被迁移到新节点的块
- * @param   disk    需要被迁移的块所在的节点
- * @param   bottleneck_disk 与disk恢复形成瓶颈的节点
- * @return  返回一个pair，pair的第一项为disk中要被迁移的块号，第二项为迁移目标节点
+ * @brief   从同一初始布局分别执行虚拟扩容后缩容与直接交换两种重分布，对比迁移块数、最大边数与耗时
  */
-pair<int, int> SelectTravelBlock(int disk, int bottleneck_disk){
-    int has_found = 0;//标记是否找到了符合要求的块
-    pair<int, int> plan_b = make_pair(-1, -1);//当最优解没有找到时，plan_b记录的是当采取非最优方案时的迁移目标节点
-    pair<int, int> plan_c = make_pair(-1, -1);
-    //遍历disk中的每一个块，判断是否满足迁移条件
-    for (int i = 0; i < disks[disk].size(); i++) {
-        vector<int> & vec_temp = block_location[disks[disk][i]];
-        if (find(vec_temp.begin(), vec_temp.end(), bottleneck_disk) == vec_temp.end()) {
-            //当前块没有与bottleneck_disk关联
-            continue;
-        } else {
-            //当前块与bottleneck_disk有关联
-            //检查新节点中是否有某个节点没有与当前块在同一条带的块
-            for (int j = g_DiskNumOrigin; j < g_DiskNumAfterScale; j++) {
-                if (find(vec_temp.begin(), vec_temp.end(), j) != vec_temp.end()) {
-                    //当前新节点中已经存放了同一条带的块，这个新节点无法作为目标节点
-                    continue;
-                } else {
-                    //当前新节点中没有与i在同一条带的块
-                    //检查当前新节点上是否还有位置
-                    if (disks[j].size() >= g_N * g_StripeNum / g_DiskNumAfterScale) {
-                        //当前新节点没有位置了
-                        plan_c = make_pair(disks[disk][i], j);
-                        continue;
-                    } else {
-                        //当前新节点上还有位置
-                        plan_b = make_pair(disks[disk][i], j);//当最优解无法找到，就放弃最后一个约束条件，采取次优解
-                        //检查假设把块迁移到这个新节点后，传输时间是否超过理论最优解
-                        int ok_flag = 1;
-                        for (int m = 0; m < vec_temp.size(); m++) {
-                            if (vec_temp[m] == disk) continue;
-                            if (G[j][vec_temp[m]] + 1 > g_Optimal) {
-                                ok_flag = 0;
-                                break;
-                            }
-                        }
-                        if (ok_flag == 1) {
-                            has_found = 1;
-                            return make_pair(disks[disk][i], j);
-                        }
-                    }
-                }
-            }
+int RunRedistributeCompare(const CliOptions &opts) {
+    SimConfig cfg = opts.base;
+    string err;
+    if (ValidateConfig(cfg, err) != 0) {
+        cerr << "Error: " << err << endl;
+        return 1;
+    }
+    if (cfg.disk_num_origin != cfg.disk_num_after_scale || cfg.evaluation == 1 || !cfg.timeline.empty()) {
+        cerr << "Error: --redistribute compare 要求扩缩容前后节点数相同，且不能用于评估模式与时间线模式" << endl;
+        return 1;
+    }
+    //两次运行必须使用相同的种子才能得到相同的初始布局
+    if (cfg.seed == 0) {
+        cfg.seed = chrono::system_clock::now().time_since_epoch().count();
+    }
+    cfg.verbose = VERBOSE_QUIET;
+    static const char *mode_name[] = {"虚拟扩容后缩容", "直接交换"};
+    SimResult res[2];
+    double ms[2];
+    SUDSimulator sim;
+    for (int mode = REDIST_VIRTUAL; mode <= REDIST_SWAP; mode++) {
+        cfg.redistribute = mode;
+        sim.Reset(cfg);
+        res[mode] = sim.Run();
+        ms[mode] = sim.Stats().redistribute_ms;
+    }
+    if (opts.base.verbose == VERBOSE_QUIET) {
+        for (int mode = REDIST_VIRTUAL; mode <= REDIST_SWAP; mode++) {
+            cout << mode_name[mode] << "：最大边数：" << res[mode].max_edge << "，迁移块数：" << res[mode].moved_blocks
+                 << "，耗时：" << ms[mode] << "ms" << endl;
         }
+        return 0;
     }
-    if (has_found == 0) {
-        if (g_Evaluation == 0)
-            cout << "采用次优解：";
-        if (plan_b.first != -1)
-            return plan_b;
-        else
-            return plan_c;
+    cout << "===== 重分布对比 =====" << endl;
+    cout << cfg.disk_num_origin << "个节点，" << cfg.stripe_num << "个条带，种子" << cfg.seed << "，理想最优解"
+         << res[REDIST_SWAP].optimal << endl;
+    cout << "方式\t最大边数\t迁移块数\t耗时(ms)" << endl;
+    for (int mode = REDIST_VIRTUAL; mode <= REDIST_SWAP; mode++) {
+        cout << mode_name[mode] << "\t" << res[mode].max_edge << (res[mode].is_optimal ? "" : "*") << "\t"
+             << res[mode].moved_blocks << "\t" << ms[mode] << endl;
     }
+    cout << "（*表示未能得到理想最优解）" << endl;
+    return 0;
 }
 
 /**
- * @brief   扩容函数
+ * @brief   按单组参数运行一次模拟，完整输出时与原先写死参数时一致。
+            可选地把迁移计划与扩缩容后的邻接矩阵写入文件
  */
-void SUDExpand() {
-    //计算每个节点需要迁移几个块
-    int travel_num = g_StripeNum * g_N / g_DiskNumOrigin - g_StripeNum * g_N / g_DiskNumAfterScale;
-    assert(travel_num > 0);
-    //进行travel_num轮迁移，每轮每个节点迁移一个块
-    int bottleneck_disk = 0;
-    int bottleneck;
-    while (travel_num--) {
-        for (int i = 0; i < g_DiskNumOrigin; i++) {
-            bottleneck = 0;
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                if (G[i][j] > bottleneck) {
-                    bottleneck = G[i][j];
-                    bottleneck_disk = j;
-                }
-            }
-            //在disks中增加新节点对应的vector
-            for (int j = 0; j < g_DiskNumAfterScale - g_DiskNumOrigin; j++) {
-                vector<int> new_disk;
-                disks.push_back(new_disk);
-            }
-            pair<int, int> travel_pair = SelectTravelBlock(i, bottleneck_disk);
-            if (travel_pair.first == -1) {
-                cout << "fatal error" << endl;
-                return;
-            }
-            if (g_Evaluation == 0)
-                cout << "将" << i << "节点的" << travel_pair.first << "块迁移至" << travel_pair.second << "节点" << endl;
-            //对边进行增删调整
-            vector<int> & vec_temp = block_location[travel_pair.first];
-            int travel_target_disk = travel_pair.second;
-            int travel_block_no = travel_pair.first;
-            for (int j = 0; j < vec_temp.size(); j++) {
-                if (vec_temp[j] == i) continue;
-                G[i][vec_temp[j]]--;
-                G[vec_temp[j]][i]--;
-                G[vec_temp[j]][travel_target_disk]++;
-                G[travel_target_disk][vec_temp[j]]++;
-            }
-            //更新disks
-            vector<int>::iterator it = find(disks[i].begin(), disks[i].end(), travel_block_no);
-            disks[i].erase(it);
-            disks[travel_target_disk].push_back(travel_block_no);
-            //更新block_location
-            it = find(block_location[travel_block_no].begin(), block_location[travel_block_no].end(), i);
-            block_location[travel_block_no].erase(it);
-            block_location[travel_block_no].push_back(travel_target_disk);
-
+int RunSingle(const CliOptions &opts) {
+    SimConfig cfg = opts.base;
+    string err;
+    LayoutFile layout;
+    if (!opts.layout_file.empty()) {
+        if (layout.Open(opts.layout_file, err) != 0) {
+            cerr << "Error: " << err << endl;
+            return 1;
+        }
+        //条带数、条带长度与扩缩容前的节点数以布局文件为准
+        const LayoutHeader &header = layout.Header();
+        cfg.stripe_num = header.stripe_num;
+        cfg.n = header.width;
+        cfg.disk_num_origin = header.disk_num;
+        cfg.external_layout = 1;
+        if (cfg.verbose > VERBOSE_QUIET) {
+            cout << "载入布局" << opts.layout_file << "：" << cfg.stripe_num << "个条带，条带长度" << cfg.n
+                 << "，" << cfg.disk_num_origin << "个节点" << endl;
         }
     }
-    //检查是否达到理想最优解
-    if (g_Evaluation == 0)
-        cout << "理想最优解为" << g_Optimal << endl;
-    cout << "SUD扩展后的邻接矩阵：" << endl;
-    int is_optimal = 1;
-    for (int i = 0; i < g_DiskNumAfterScale; i++) {
-        for (int j = 0; j < g_DiskNumAfterScale; j++) {
-            cout << G[i][j] << " ";
-            if (G[i][j] > g_Optimal) {
-                is_optimal = 0;
-            }
+    DiskProfile profile;
+    if (!opts.profile_file.empty()) {
+        if (profile.Load(opts.profile_file, err) != 0) {
+            cerr << "Error: " << err << endl;
+            return 1;
         }
-        cout << endl;
+        cfg.weighted_disks = 1;
     }
-    if (g_Evaluation == 0) {
-        if (is_optimal == 1) {
-            cout << "得到理想最优解" << endl;
-        } else {
-            cout << "未能得到理想最优解" << endl;
+    if (ValidateConfig(cfg, err) != 0) {
+        cerr << "Error: " << err << endl;
+        return 1;
+    }
+    if (!cfg.timeline.empty()) {
+        if (cfg.evaluation == 1 || cfg.recovery || opts.netsim) {
+            cerr << "Error: 时间线模式不支持评估模式、故障恢复分析与网络模拟" << endl;
+            return 1;
         }
+        //邻接矩阵的输出与统计报告按最后一步之后的节点数
+        cfg.disk_num_after_scale = cfg.timeline.back();
     }
-}
-
-/**
- * @brief   缩容过程中，寻找应该将指定块迁移到哪个容器中
- * @param   block_no    要被迁移的块号
- */
-int FindTargetDisk(int block_no){
-    //计算缩容后每个节点的期望块数
-    int disk_block_num = g_N * g_StripeNum / g_DiskNumAfterScale;
-    vector<int>::iterator it;
-    int plan_b = -1;
-    for (int i = 0; i < g_DiskNumAfterScale; i++) {
-        it = find(disks[i].begin(), disks[i].end(), block_no);
-        if (it != disks[i].end()) {
-            //当前节点中已经有了和block_no在同一个条带的块
-            continue;
-        } else {
-            //当前节点中没有和block_no在同一个条带的块
-            if (disks[i].size() + 1 > disk_block_num) {
-                //当前节点已经没有位置
-                plan_b = i;
-                continue;
-            } else {
-                //当前节点还有位置
-                plan_b = i;
-                //判断如果转移到这个节点，是否会破坏理论最优解
-                int is_OK = 1;
-                for (int j = 0; j < block_location[block_no].size(); j++) {
-                    if (G[i][block_location[block_no][j]] + 1 > g_Optimal) {
-                        is_OK = 0;
-                        break;
-                    }
-                }
-                if (is_OK) {
-                    //找到了合适的目标节点
-                    return i;
-                }
-            }
+    Topology topology;
+    if (!opts.topology_file.empty()) {
+        if (topology.Load(opts.topology_file, err) != 0 || !topology.Covers(cfg.MaxDiskNum(), err)) {
+            cerr << "Error: " << err << endl;
+            return 1;
         }
     }
-    if (g_Evaluation == 0)
-        cout << "采用次优解：";
-    return plan_b;
-}
-
-/**
- * @brief   缩容函数
- */
-void SUDShrink(){
-    vector<int>::iterator it;
-    for (int i = g_DiskNumAfterScale; i < g_DiskNumOrigin; i++) {
-        while (!disks[i].empty()) {
-            it = disks[i].begin();
-            int block_temp = *it;
-            disks[i].erase(it);
-            for (int j = 0; j < block_location[block_temp].size(); j++) {
-                if (block_location[block_temp][j] == i) continue;
-                G[i][block_location[block_temp][j]]--;
-                G[block_location[block_temp][j]][i]--;
-            }
-            it = find(block_location[block_temp].begin(), block_location[block_temp].end(), i);
-            block_location[block_temp].erase(it);
-            int target_disk = FindTargetDisk(block_temp);
-            if (target_disk == -1) {
-                cout << "fatal error" << endl;
-                return;
-            }
-            if (g_Evaluation == 0)
-                cout << "将" << i << "节点的" << block_temp << "块迁移至" << target_disk << "节点" << endl;
-            disks[target_disk].push_back(block_temp);
-            for (int j = 0; j < block_location[block_temp].size(); j++) {
-                G[target_disk][block_location[block_temp][j]]++;
-                G[block_location[block_temp][j]][target_disk]++;
-            }
-            block_location[block_temp].push_back(target_disk);
+    if (opts.netsim && opts.net.streams < 1) {
+        cerr << "Error: --streams 必须为正" << endl;
+        return 1;
+    }
+    PlanWriter writer;
+    if (!opts.plan_file.empty() && writer.Open(opts.plan_file, opts.plan_format) != 0) {
+        cerr << "Error: 无法打开迁移计划文件 " << opts.plan_file << endl;
+        return 1;
+    }
+    ofstream stats_file;
+    int ok;
+    ostream *stats_out = OpenStatsStream(opts.stats_file, stats_file, ok);
+    if (!ok) return 1;
+    SUDSimulator sim;
+    sim.Reset(cfg);
+    sim.SetLayout(layout.IsOpen() ? &layout : nullptr);
+    sim.SetDiskProfile(cfg.weighted_disks ? &profile : nullptr);
+    sim.SetTopology(opts.topology_file.empty() ? nullptr : &topology);
+    sim.SetPlanWriter(writer.IsOpen() ? &writer : nullptr);
+    vector<MoveRecord> plan;
+    sim.SetPlanRecord(opts.netsim ? &plan : nullptr);
+    vector<TimelineStep> steps;
+    SimResult res = cfg.timeline.empty() ? sim.Run() : sim.RunTimeline(steps);
+    if (writer.IsOpen()) {
+        long long count = writer.Count();
+        if (writer.Close() != 0) {
+            cerr << "Error: 写入迁移计划文件 " << opts.plan_file << " 失败" << endl;
+            return 1;
+        }
+        if (cfg.verbose > VERBOSE_QUIET)
+            cout << "已将" << count << "条迁移记录写入" << opts.plan_file << endl;
+    }
+    if (!opts.matrix_file.empty() && sim.GetGraph().DumpBinary(opts.matrix_file, cfg.disk_num_after_scale) != 0) {
+        cerr << "Error: 写入邻接矩阵文件 " << opts.matrix_file << " 失败" << endl;
+        return 1;
+    }
+    if (stats_out != nullptr) {
+        sim.Stats().WriteJson(*stats_out, cfg, res);
+        *stats_out << endl;
+    }
+    if (!cfg.timeline.empty() && cfg.verbose > VERBOSE_QUIET) {
+        PrintTimeline(steps, res);
+    }
+    if (cfg.recovery && cfg.evaluation == 0) {
+        if (cfg.verbose == VERBOSE_QUIET) {
+            cout << "单节点故障平均最大读负载：扩缩容前" << res.recovery_before.mean_bottleneck << "，扩缩容后"
+                 << res.recovery_after.mean_bottleneck << endl;
+        } else {
+            cout << "===== 故障恢复 =====" << endl;
+            int detail = cfg.recovery_disk >= 0 || cfg.verbose == VERBOSE_FULL;
+            PrintRecoveryResult("扩缩容前", res.recovery_before, detail);
+            if (res.fatal == 0)
+                PrintRecoveryResult("扩缩容后", res.recovery_after, detail);
         }
     }
-    //检查是否达到理想最优解
-    if (g_Evaluation == 0) {
-        cout << "理想最优解为" << g_Optimal << endl;
-        cout << "缩容后各节点中的块数：" << endl;
-        for (int i = 0; i < g_DiskNumOrigin; i++) {
-            cout << disks[i].size() << " ";
+    if (opts.netsim) {
+        //重分布时计划中包含虚拟扩容节点
+        int node_num = max(cfg.disk_num_origin, cfg.disk_num_after_scale);
+        for (int i = 0; i < plan.size(); i++) node_num = max(node_num, plan[i].to + 1);
+        vector<double> nic_bw(node_num, opts.net.nic_bw);
+        vector<double> disk_bw(node_num, opts.net.disk_bw);
+        if (cfg.weighted_disks) {
+            for (int i = 0; i < node_num; i++) disk_bw[i] *= profile.Bandwidth(i);
         }
-        cout << endl;
-    }
-    cout << "缩容后的邻接矩阵：" << endl;
-    int is_optimal = 1;
-    for (int i = 0; i < g_DiskNumAfterScale; i++) {
-        for (int j = 0; j < g_DiskNumAfterScale; j++) {
-            cout << G[i][j] << " ";
-            if (G[i][j] > g_Optimal) {
-                is_optimal = 0;
-            }
+        NetSimResult net_res;
+        RunNetSim(plan, node_num, nic_bw, disk_bw, opts.net, net_res);
+        if (cfg.verbose == VERBOSE_QUIET) {
+            cout << "迁移完成时间：" << net_res.makespan << "秒，下界：" << net_res.lower_bound << "秒，关键路径："
+                 << net_res.critical_path.size() << "次迁移" << endl;
+        } else {
+            PrintNetSimResult(plan, opts.net, net_res);
         }
-        cout << endl;
     }
-    if (g_Evaluation == 0) {
-        if (is_optimal == 1) {
-            cout << "得到理想最优解" << endl;
+    if (cfg.verbose == VERBOSE_QUIET) {
+        //安静模式下只输出一行汇总
+        if (cfg.evaluation == 1) {
+            cout << "SUD平均传输开销：" << res.sud_cost << "，随机重分布平均传输开销：" << res.random_cost << endl;
         } else {
-            cout << "未能得到理想最优解" << endl;
+            cout << "理想最优解：" << res.optimal << "，最大边数：" << res.max_edge << "，迁移块数："
+                 << res.moved_blocks;
+            if (cfg.weighted_disks)
+                cout << "，理想恢复时间：" << res.optimal_time << "，最大恢复时间：" << res.max_time;
+            if (!opts.topology_file.empty())
+                cout << "，主机间：" << res.level_edge[LEVEL_HOST] << "/" << res.level_limit[LEVEL_HOST]
+                     << "，机架间：" << res.level_edge[LEVEL_RACK] << "/" << res.level_limit[LEVEL_RACK];
+            cout << endl;
         }
     }
+    return 0;
 }
 
 /**
- * @brief   数据重新分布函数
+ * @brief   多线程重复评估，输出平均传输开销的统计结果
  */
-void Redistribute(){
-    for (int i = g_DiskNumOrigin + 1; i < g_MaxDiskNum; i++) {
-        if ((g_N * g_StripeNum) % i == 0) {
-            g_DiskNumAfterScale = i;
-            break;
-        }
+int RunTrials(const CliOptions &opts) {
+    string err;
+    if (ValidateConfig(opts.base, err) != 0) {
+        cerr << "Error: " << err << endl;
+        return 1;
+    }
+    if (opts.base.disk_num_origin == opts.base.disk_num_after_scale) {
+        cout << "Error: 评估模式要求扩缩容前后的节点数不同" << endl;
+        return 1;
     }
-    cout << "虚拟扩容节点数为" << g_DiskNumAfterScale << endl;
-    g_Optimal = 1 + (g_K * g_StripeNum * g_N) / (g_DiskNumAfterScale * (g_DiskNumAfterScale - 1));
-    SUDExpand();
-    int temp = g_DiskNumAfterScale;
-    g_DiskNumAfterScale = g_DiskNumOrigin;
-    g_DiskNumOrigin = temp;
-    g_Optimal = 1 + (g_K * g_StripeNum * g_N) / (g_DiskNumAfterScale * (g_DiskNumAfterScale - 1));
-    SUDShrink();
+    MonteCarloResult res;
+    RunMonteCarlo(opts.base, opts.trials, opts.threads, res);
+    PrintMonteCarloResult(opts.base, res);
+    return 0;
 }
 
 /**
- * @brief   评估函数
+ * @brief   按扫参文件批量运行。所有参数组合共用同一个模拟器，避免每组参数重新分配状态，
+            每组参数输出一行CSV结果
  */
-void Evaluation(){
-    double cost;
-    int max;
-    if (g_DiskNumOrigin < g_DiskNumAfterScale) {
-        InitDisks();
-        cout << "根据随机数据生成的邻接矩阵：" << endl;
-        InitGraph();
-        SUDExpand();
-        for(int i = 0; i < g_DiskNumAfterScale; i++) {
-            max = 0;
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                max = G[i][j] > max ? G[i][j] : max;
-            }
-            cost += (double)max;
-        }
-        cost = (double)cost / g_DiskNumAfterScale;
-        cout << "平均传输开销：" << cost << endl << endl;
-        int temp = g_DiskNumOrigin;
-        g_DiskNumOrigin = g_DiskNumAfterScale;
-        disks.clear();
-        block_location.clear();
-        for (int i = 0; i < g_DiskNumAfterScale; i++) {
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                G[i][j] = 0;
-            }
-        }
-        InitDisks();
-        cout << "随机扩展后生成的邻接矩阵：" << endl;
-        InitGraph();
-        for(int i = 0; i < g_DiskNumAfterScale; i++) {
-            max = 0;
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                max = G[i][j] > max ? G[i][j] : max;
-            }
-            cost += (double)max;
-        }
-        cost = (double)cost / g_DiskNumAfterScale;
-        cout << "平均传输开销：" << cost << endl << endl;
-        g_DiskNumOrigin = temp;
-    } else if (g_DiskNumOrigin > g_DiskNumAfterScale) {
-        InitDisks();
-        cout << "根据随机数据生成的邻接矩阵：" << endl;
-        InitGraph();
-        SUDShrink();
-        for(int i = 0; i < g_DiskNumAfterScale; i++) {
-            max = 0;
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                max = G[i][j] > max ? G[i][j] : max;
-            }
-            cost += (double)max;
+int RunSweep(const CliOptions &opts) {
+    vector<SimConfig> configs;
+    if (LoadSweepFile(opts.sweep_file, opts.base, configs) != 0) {
+        return 1;
+    }
+    ofstream file;
+    if (!opts.output_file.empty()) {
+        file.open(opts.output_file);
+        if (!file) {
+            cerr << "Error: 无法打开输出文件 " << opts.output_file << endl;
+            return 1;
         }
-        cost = (double)cost / g_DiskNumAfterScale;
-        cout << "平均传输开销：" << cost << endl << endl;
-        int temp = g_DiskNumOrigin;
-        g_DiskNumOrigin = g_DiskNumAfterScale;
-        disks.clear();
-        block_location.clear();
-        for (int i = 0; i < g_DiskNumAfterScale; i++) {
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                G[i][j] = 0;
-            }
+    }
+    ostream &out = opts.output_file.empty() ? cout : file;
+    ofstream stats_file;
+    int ok;
+    ostream *stats_out = OpenStatsStream(opts.stats_file, stats_file, ok);
+    if (!ok) return 1;
+    out << "origin,target,stripes,n,k,optimal,max_edge,is_optimal,moved_blocks,fatal,time_ms,error" << endl;
+    SUDSimulator sim;
+    for (int i = 0; i < configs.size(); i++) {
+        SimConfig cfg = configs[i];
+        cfg.verbose = VERBOSE_QUIET;
+        out << cfg.disk_num_origin << "," << cfg.disk_num_after_scale << "," << cfg.stripe_num << ","
+            << cfg.n << "," << cfg.k << ",";
+        string err;
+        if (ValidateConfig(cfg, err) != 0) {
+            out << ",,,,,," << err << "\n";
+            continue;
         }
-        InitDisks();
-        cout << "随机缩容后生成的邻接矩阵：" << endl;
-        InitGraph();
-        for(int i = 0; i < g_DiskNumAfterScale; i++) {
-            max = 0;
-            for (int j = 0; j < g_DiskNumAfterScale; j++) {
-                max = G[i][j] > max ? G[i][j] : max;
-            }
-            cost += (double)max;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        sim.Reset(cfg);
+        SimResult res = sim.Run();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        out << res.optimal << "," << res.max_edge << "," << res.is_optimal << "," << res.moved_blocks << ","
+            << res.fatal << "," << ms << ",\n";
+        if (stats_out != nullptr) {
+            sim.Stats().WriteJson(*stats_out, cfg, res);
+            *stats_out << "\n";
         }
-        cost = (double)cost / g_DiskNumAfterScale;
-        cout << "平均传输开销：" << cost << endl << endl;
-        g_DiskNumOrigin = temp;
     }
+    out.flush();
+    if (stats_out != nullptr) stats_out->flush();
+    return 0;
 }
 
+/**
+ * @brief   把--convert-layout指定的文本布局转换为--out指定的二进制布局文件
+ */
+int RunConvert(const CliOptions &opts) {
+    if (opts.output_file.empty()) {
+        cerr << "Error: --convert-layout 需要用--out指定输出文件" << endl;
+        return 1;
+    }
+    LayoutHeader header;
+    string err;
+    if (ConvertLayout(opts.convert_layout, opts.output_file, header, err) != 0) {
+        cerr << "Error: " << err << endl;
+        return 1;
+    }
+    cout << "已转换" << header.stripe_num << "个条带，条带长度" << header.width << "，"
+         << header.disk_num << "个节点，写入" << opts.output_file << endl;
+    return 0;
+}
 
-int main() {
-    int total_block_num = g_N * g_StripeNum;
-    if ((total_block_num % g_DiskNumOrigin != 0) || (total_block_num % g_DiskNumAfterScale != 0)) {
-        cout << "Error: 无法保证各节点中块数相同" << endl;
-        return 0;
+int main(int argc, char **argv) {
+    CliOptions opts;
+    int ret = ParseArgs(argc, argv, opts);
+    if (ret != 0) {
+        PrintUsage(argv[0]);
+        return ret < 0 ? 1 : 0;
     }
-    if (g_Evaluation == 0) {
-        InitDisks();
-        InitGraph();
-        if (g_DiskNumOrigin < g_DiskNumAfterScale) {
-            //执行扩容操作
-            SUDExpand();
-        } else if (g_DiskNumOrigin > g_DiskNumAfterScale) {
-            //执行缩容操作
-            SUDShrink();
-        } else {
-            //执行数据重新分布操作
-            Redistribute();
+    if (opts.simd_level >= 0) {
+        SetSimdLevel(opts.simd_level);
+    }
+    if (!opts.convert_layout.empty()) {
+        return RunConvert(opts);
+    }
+    if (!opts.layout_file.empty() && (!opts.sweep_file.empty() || opts.trials > 0 || opts.base.evaluation == 1)) {
+        cerr << "Error: --layout 只能用于单次扩缩容或重分布" << endl;
+        return 1;
+    }
+    if (!opts.profile_file.empty() && (!opts.sweep_file.empty() || opts.trials > 0 || opts.redistribute_compare)) {
+        cerr << "Error: --disk-profile 只能用于单次运行或时间线模式" << endl;
+        return 1;
+    }
+    if (!opts.topology_file.empty() && (!opts.sweep_file.empty() || opts.trials > 0 || opts.redistribute_compare
+                                        || !opts.profile_file.empty())) {
+        cerr << "Error: --topology 只能用于单次运行或时间线模式，且不能与--disk-profile同时使用" << endl;
+        return 1;
+    }
+    if (!opts.base.timeline.empty() && (!opts.sweep_file.empty() || opts.trials > 0)) {
+        cerr << "Error: --timeline 不能与扫参或蒙特卡洛评估同时使用" << endl;
+        return 1;
+    }
+    if (opts.redistribute_compare) {
+        return RunRedistributeCompare(opts);
+    }
+    if (!opts.sweep_file.empty()) {
+        if (opts.base.evaluation == 1 || opts.trials > 0) {
+            cerr << "Error: 扫参模式不支持评估模式" << endl;
+            return 1;
         }
-    } else {
-        Evaluation();
+        return RunSweep(opts);
     }
-    return 0;
-}
\ No newline at end of file
+    if (opts.trials > 0) {
+        return RunTrials(opts);
+    }
+    return RunSingle(opts);
+}
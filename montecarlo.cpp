@@ -0,0 +1,141 @@
+/*********************************************************************************
+  * FileName:  montecarlo.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  多线程蒙特卡洛评估：重复多次独立试验，统计SUD与随机重分布的平均传输开销
+**********************************************************************************/
+
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <math.h>
+#include "montecarlo.h"
+#include "simulator.h"
+
+using namespace std;
+
+/**
+ * @brief   自由度为df时t分布的0.975分位数，df大于30时用正态分布近似
+ */
+static double TQuantile975(int df) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df <= 0) return 0;
+    if (df <= 30) return table[df - 1];
+    return 1.960;
+}
+
+TrialStats ComputeStats(const vector<double> &samples) {
+    TrialStats stats;
+    int n = samples.size();
+    if (n == 0) return stats;
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    stats.mean = sum / n;
+    double sq = 0;
+    for (int i = 0; i < n; i++) {
+        sq += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+    }
+    stats.stddev = n > 1 ? sqrt(sq / (n - 1)) : 0;
+    double half = TQuantile975(n - 1) * stats.stddev / sqrt((double)n);
+    stats.ci_low = stats.mean - half;
+    stats.ci_high = stats.mean + half;
+    return stats;
+}
+
+/**
+ * @brief   由基准种子与试验编号导出该次试验的种子（splitmix64），相邻试验的随机序列互不相关
+ */
+unsigned long long TrialSeed(unsigned long long base_seed, int trial) {
+    unsigned long long z = base_seed + 0x9E3779B97F4A7C15ULL * (unsigned long long)(trial + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return z == 0 ? 1 : z;
+}
+
+/**
+ * @brief   用threads个线程执行trials次独立的评估试验。每个线程拥有自己的模拟器，
+            试验按编号领取，结果按编号存放，因此统计结果与线程数无关
+ * @return  成功返回0，参数不合法返回-1
+ */
+int RunMonteCarlo(const SimConfig &cfg, int trials, int threads, MonteCarloResult &res) {
+    if (trials <= 0 || cfg.disk_num_origin == cfg.disk_num_after_scale) {
+        return -1;
+    }
+    if (threads <= 0) {
+        threads = thread::hardware_concurrency();
+        threads = threads > 0 ? threads : 1;
+    }
+    threads = threads < trials ? threads : trials;
+    res.trials = trials;
+    res.threads = threads;
+    res.base_seed = cfg.seed;
+    if (res.base_seed == 0) {
+        res.base_seed = chrono::system_clock::now().time_since_epoch().count();
+    }
+    res.sud_costs.assign(trials, 0);
+    res.random_costs.assign(trials, 0);
+    vector<int> fatal(trials, 0);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    atomic<int> next_trial(0);
+    auto worker = [&]() {
+        SUDSimulator sim;
+        SimConfig trial_cfg = cfg;
+        trial_cfg.evaluation = 1;
+        trial_cfg.verbose = VERBOSE_QUIET;
+        while (true) {
+            int t = next_trial.fetch_add(1);
+            if (t >= trials) break;
+            trial_cfg.seed = TrialSeed(res.base_seed, t);
+            sim.Reset(trial_cfg);
+            SimResult r = sim.Run();
+            res.sud_costs[t] = r.sud_cost;
+            res.random_costs[t] = r.random_cost;
+            fatal[t] = r.fatal;
+        }
+    };
+    vector<thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.push_back(thread(worker));
+    }
+    worker();
+    for (int i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+    res.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> diff(trials);
+    res.fatal_trials = 0;
+    for (int t = 0; t < trials; t++) {
+        diff[t] = res.sud_costs[t] - res.random_costs[t];
+        res.fatal_trials += fatal[t];
+    }
+    res.sud = ComputeStats(res.sud_costs);
+    res.random = ComputeStats(res.random_costs);
+    res.diff = ComputeStats(diff);
+    return 0;
+}
+
+static void PrintStats(const char *name, const TrialStats &stats) {
+    cout << name << "：均值 " << stats.mean << "，标准差 " << stats.stddev
+         << "，95%置信区间 [" << stats.ci_low << ", " << stats.ci_high << "]" << endl;
+}
+
+void PrintMonteCarloResult(const SimConfig &cfg, const MonteCarloResult &res) {
+    cout << "蒙特卡洛评估：" << cfg.disk_num_origin << " -> " << cfg.disk_num_after_scale << "，"
+         << cfg.stripe_num << "个条带，n=" << cfg.n << "，k=" << cfg.k << "，"
+         << res.trials << "次试验，" << res.threads << "个线程，种子" << res.base_seed << endl;
+    PrintStats("SUD平均传输开销", res.sud);
+    PrintStats("随机重分布平均传输开销", res.random);
+    PrintStats("差值(SUD-随机)", res.diff);
+    if (res.fatal_trials > 0) {
+        cout << "其中" << res.fatal_trials << "次试验出现fatal error" << endl;
+    }
+    cout << "耗时" << res.seconds << "秒" << endl;
+}
@@ -0,0 +1,41 @@
+/*********************************************************************************
+  * FileName:  montecarlo.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  多线程蒙特卡洛评估：重复多次独立试验，统计SUD与随机重分布的平均传输开销
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_MONTECARLO_H
+#define SUD_SCALE_SIMULATION_MONTECARLO_H
+
+#include <vector>
+#include "config.h"
+using namespace std;
+
+/*一组样本的统计量*/
+struct TrialStats {
+    double mean = 0;
+    double stddev = 0;      //样本标准差
+    double ci_low = 0;      //均值的95%置信区间
+    double ci_high = 0;
+};
+
+struct MonteCarloResult {
+    int trials = 0;
+    int threads = 0;
+    unsigned long long base_seed = 0;   //第t次试验的种子由base_seed与t导出，可用于复现
+    int fatal_trials = 0;               //出现无法迁移的块的试验数
+    vector<double> sud_costs;           //每次试验SUD扩缩容后的平均传输开销
+    vector<double> random_costs;        //每次试验随机重分布的平均传输开销
+    TrialStats sud;
+    TrialStats random;
+    TrialStats diff;                    //同一次试验中两者之差（SUD - 随机）
+    double seconds = 0;
+};
+
+TrialStats ComputeStats(const vector<double> &samples);
+unsigned long long TrialSeed(unsigned long long base_seed, int trial);
+int RunMonteCarlo(const SimConfig &cfg, int trials, int threads, MonteCarloResult &res);
+void PrintMonteCarloResult(const SimConfig &cfg, const MonteCarloResult &res);
+
+#endif //SUD_SCALE_SIMULATION_MONTECARLO_H
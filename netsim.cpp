@@ -0,0 +1,209 @@
+/*********************************************************************************
+  * FileName:  netsim.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  按迁移计划进行离散事件网络模拟，估计迁移的实际完成时间
+**********************************************************************************/
+
+#include <iostream>
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include "netsim.h"
+
+using namespace std;
+
+/*一个阶段的模拟状态，事件堆中保存<完成时间, 迁移下标>*/
+class PhaseSim {
+public:
+    PhaseSim(const vector<MoveRecord> &plan, const vector<int> &order, int node_num, const vector<double> &rate,
+             const NetConfig &net, double start, vector<int> &pred, vector<double> &finish)
+        : plan(plan), order(order), rate(rate), net(net), now(start), pred(pred), finish(finish),
+          free_out(node_num, net.streams), free_in(node_num, net.streams),
+          queue_begin(node_num + 1, 0), head(node_num, 0), waiting_on(node_num, -1), waiters(node_num) {
+        //order中的迁移按源节点分组，queue_begin[i]为源节点i的第一个迁移在order中的位置
+        for (int i = 0; i < order.size(); i++) queue_begin[plan[order[i]].from + 1]++;
+        for (int i = 0; i < node_num; i++) {
+            queue_begin[i + 1] += queue_begin[i];
+            head[i] = queue_begin[i];
+        }
+    }
+
+    /**
+     * @brief   执行到本阶段所有迁移完成
+     * @return  本阶段最后一个完成的迁移的下标，没有迁移时返回-1
+     */
+    int Run() {
+        int last = -1;
+        for (int i = 0; i + 1 < queue_begin.size(); i++) TryStart(i, -1);
+        while (!events.empty()) {
+            pop_heap(events.begin(), events.end(), greater<pair<double, int> >());
+            pair<double, int> ev = events.back();
+            events.pop_back();
+            now = ev.first;
+            last = ev.second;
+            const MoveRecord &m = plan[ev.second];
+            free_out[m.from]++;
+            free_in[m.to]++;
+            //先唤醒在目标节点上排队的源节点，再让本次迁移的源节点继续发起下一个迁移
+            while (free_in[m.to] > 0 && !waiters[m.to].empty()) {
+                int w = waiters[m.to].front();
+                waiters[m.to].pop_front();
+                if (waiting_on[w] == m.to) waiting_on[w] = -1;
+                TryStart(w, ev.second);
+            }
+            TryStart(m.from, ev.second);
+        }
+        return last;
+    }
+
+    double Now() const { return now; }
+
+private:
+    /**
+     * @brief   源节点src按顺序发起迁移，直到没有空闲发送端口或队首迁移的目标节点没有空闲接收端口
+     * @param   cause   触发本次发起的迁移，用于回溯关键路径
+     */
+    void TryStart(int src, int cause) {
+        int end = queue_begin[src + 1];
+        while (free_out[src] > 0 && head[src] < end) {
+            int t = order[head[src]];
+            int dst = plan[t].to;
+            if (free_in[dst] == 0) {
+                if (waiting_on[src] != dst) {
+                    waiting_on[src] = dst;
+                    waiters[dst].push_back(src);
+                }
+                return;
+            }
+            head[src]++;
+            free_out[src]--;
+            free_in[dst]--;
+            double r = min(rate[src], rate[dst]) / net.streams;
+            finish[t] = now + net.block_mb / r;
+            pred[t] = cause;
+            events.push_back(make_pair(finish[t], t));
+            push_heap(events.begin(), events.end(), greater<pair<double, int> >());
+        }
+    }
+
+    const vector<MoveRecord> &plan;
+    const vector<int> &order;
+    const vector<double> &rate;
+    const NetConfig &net;
+    double now;
+    vector<int> &pred;
+    vector<double> &finish;
+    vector<int> free_out;
+    vector<int> free_in;
+    vector<int> queue_begin;
+    vector<int> head;               //每个源节点下一个要发起的迁移在order中的位置
+    vector<int> waiting_on;         //源节点正在哪个目标节点上排队，-1表示没有
+    vector<deque<int> > waiters;    //每个目标节点上排队的源节点
+    vector<pair<double, int> > events;
+};
+
+void RunNetSim(const vector<MoveRecord> &plan, int node_num, const vector<double> &nic_bw,
+               const vector<double> &disk_bw, const NetConfig &net, NetSimResult &res) {
+    res = NetSimResult();
+    res.transfers = plan.size();
+    res.phase_time.assign(PHASE_REBALANCE + 1, 0);
+    res.out_busy.assign(node_num, 0);
+    res.in_busy.assign(node_num, 0);
+    vector<double> rate(node_num);
+    for (int i = 0; i < node_num; i++) rate[i] = min(nic_bw[i], disk_bw[i]);
+    vector<int> pred(plan.size(), -1);
+    vector<double> finish(plan.size(), 0);
+    //同一阶段内按源节点稳定排序，保持每个源节点的迁移顺序
+    vector<int> order;
+    order.reserve(plan.size());
+    int last = -1;
+    for (int phase = PHASE_EXPAND; phase <= PHASE_REBALANCE; phase++) {
+        order.clear();
+        for (int i = 0; i < plan.size(); i++) {
+            if (plan[i].phase == phase) order.push_back(i);
+        }
+        if (order.empty()) continue;
+        stable_sort(order.begin(), order.end(), [&plan](int a, int b) { return plan[a].from < plan[b].from; });
+        PhaseSim sim(plan, order, node_num, rate, net, res.makespan, pred, finish);
+        int phase_last = sim.Run();
+        //阶段之间有屏障，下一阶段的第一批迁移由本阶段最后完成的迁移触发
+        if (last != -1) {
+            for (int i = 0; i < order.size(); i++) {
+                if (pred[order[i]] == -1) pred[order[i]] = last;
+            }
+        }
+        last = phase_last;
+        res.phase_time[phase] = sim.Now() - res.makespan;
+        res.makespan = sim.Now();
+    }
+    //统计端口与链路的占用时间
+    unordered_map<unsigned long long, LinkStat> links;
+    vector<long long> out_count(node_num, 0), in_count(node_num, 0);
+    for (int i = 0; i < plan.size(); i++) {
+        const MoveRecord &m = plan[i];
+        double duration = net.block_mb / (min(rate[m.from], rate[m.to]) / net.streams);
+        res.out_busy[m.from] += duration;
+        res.in_busy[m.to] += duration;
+        out_count[m.from]++;
+        in_count[m.to]++;
+        LinkStat &link = links[((unsigned long long)m.from << 32) | (unsigned)m.to];
+        link.from = m.from;
+        link.to = m.to;
+        link.transfers++;
+        link.busy += duration;
+    }
+    for (int i = 0; i < node_num; i++) {
+        double bound = max(out_count[i], in_count[i]) * net.block_mb / rate[i];
+        res.lower_bound = max(res.lower_bound, bound);
+    }
+    for (unordered_map<unsigned long long, LinkStat>::iterator it = links.begin(); it != links.end(); ++it) {
+        res.top_links.push_back(it->second);
+    }
+    int top = min((int)res.top_links.size(), net.top_links);
+    partial_sort(res.top_links.begin(), res.top_links.begin() + top, res.top_links.end(),
+                 [](const LinkStat &a, const LinkStat &b) {
+                     if (a.busy != b.busy) return a.busy > b.busy;
+                     return a.from != b.from ? a.from < b.from : a.to < b.to;
+                 });
+    res.top_links.resize(top);
+    //从最后完成的迁移沿触发关系回溯，得到关键路径
+    for (int t = last; t != -1; t = pred[t]) res.critical_path.push_back(t);
+    reverse(res.critical_path.begin(), res.critical_path.end());
+}
+
+void PrintNetSimResult(const vector<MoveRecord> &plan, const NetConfig &net, const NetSimResult &res) {
+    static const char *phase_name[] = {"扩容", "缩容", "直接重分布"};
+    cout << "===== 网络模拟 =====" << endl;
+    cout << "迁移数：" << res.transfers << "，块大小：" << net.block_mb << "MB，网卡带宽：" << net.nic_bw
+         << "MB/s，磁盘带宽：" << net.disk_bw << "MB/s，每节点并发数：" << net.streams << endl;
+    cout << "完成时间：" << res.makespan << "秒，下界：" << res.lower_bound << "秒" << endl;
+    for (int i = 0; i < res.phase_time.size(); i++) {
+        if (res.phase_time[i] > 0)
+            cout << "  " << phase_name[i] << "阶段：" << res.phase_time[i] << "秒" << endl;
+    }
+    if (res.makespan <= 0) return;
+    int busiest_out = max_element(res.out_busy.begin(), res.out_busy.end()) - res.out_busy.begin();
+    int busiest_in = max_element(res.in_busy.begin(), res.in_busy.end()) - res.in_busy.begin();
+    double capacity = res.makespan * net.streams;
+    cout << "发送端口利用率最高的节点：" << busiest_out << "（" << 100 * res.out_busy[busiest_out] / capacity
+         << "%），接收端口利用率最高的节点：" << busiest_in << "（" << 100 * res.in_busy[busiest_in] / capacity
+         << "%）" << endl;
+    cout << "占用时间最长的链路：" << endl;
+    for (int i = 0; i < res.top_links.size(); i++) {
+        const LinkStat &link = res.top_links[i];
+        cout << "  " << link.from << " -> " << link.to << "：" << link.transfers << "次迁移，利用率"
+             << 100 * link.busy / res.makespan << "%" << endl;
+    }
+    //关键路径较长时只输出经过的节点序列的首尾部分
+    cout << "关键路径：共" << res.critical_path.size() << "次迁移" << endl;
+    const int show = 8;
+    for (int i = 0; i < res.critical_path.size(); i++) {
+        if (i == show && res.critical_path.size() > 2 * show) {
+            cout << "  ..." << endl;
+            i = res.critical_path.size() - show;
+        }
+        const MoveRecord &m = plan[res.critical_path[i]];
+        cout << "  条带" << m.stripe << "：" << m.from << " -> " << m.to << endl;
+    }
+}
@@ -0,0 +1,52 @@
+/*********************************************************************************
+  * FileName:  netsim.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  按迁移计划进行离散事件网络模拟，估计迁移的实际完成时间
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_NETSIM_H
+#define SUD_SCALE_SIMULATION_NETSIM_H
+
+#include <vector>
+#include "config.h"
+#include "planwriter.h"
+using namespace std;
+
+/*
+ * 每个节点有streams个发送端口与streams个接收端口。一次迁移同时占用源节点的一个发送端口与目标节点的
+ * 一个接收端口，速率为两端的min(网卡带宽, 磁盘带宽) / streams中的较小值。
+ * 每个源节点按计划中的顺序发起迁移，队首迁移的目标节点没有空闲接收端口时，源节点在目标节点上排队等待。
+ * 不同阶段之间有屏障，重分布的缩容阶段在扩容阶段全部完成后才开始
+ */
+
+/*一条链路（源节点到目标节点）的统计*/
+struct LinkStat {
+    int from = 0;
+    int to = 0;
+    long long transfers = 0;
+    double busy = 0;        //该链路上各次迁移的持续时间之和
+};
+
+struct NetSimResult {
+    long long transfers = 0;
+    double makespan = 0;                //全部迁移的完成时间，秒
+    double lower_bound = 0;             //最忙节点的发送或接收量除以其带宽，任何调度都不会更快
+    vector<double> phase_time;          //每个阶段的耗时，下标为MovePhase
+    vector<double> out_busy;            //每个节点发送端口的占用时间之和
+    vector<double> in_busy;             //每个节点接收端口的占用时间之和
+    vector<LinkStat> top_links;         //占用时间最长的若干条链路，按占用时间降序
+    vector<int> critical_path;          //关键路径上的迁移在计划中的下标，按时间顺序
+};
+
+/**
+ * @brief   模拟按plan执行迁移的过程
+ * @param   plan    迁移计划，同一阶段内每个源节点的迁移按在plan中的顺序发起
+ * @param   node_num    节点数，须大于plan中出现的所有节点号
+ * @param   nic_bw, disk_bw 每个节点的网卡与磁盘带宽，MB/s
+ */
+void RunNetSim(const vector<MoveRecord> &plan, int node_num, const vector<double> &nic_bw,
+               const vector<double> &disk_bw, const NetConfig &net, NetSimResult &res);
+void PrintNetSimResult(const vector<MoveRecord> &plan, const NetConfig &net, const NetSimResult &res);
+
+#endif //SUD_SCALE_SIMULATION_NETSIM_H
@@ -0,0 +1,101 @@
+/*********************************************************************************
+  * FileName:  pairindex.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  节点对到共享条带的索引，用于直接列出两个节点共同存放的条带
+**********************************************************************************/
+
+#include <algorithm>
+#include "pairindex.h"
+
+using namespace std;
+
+void PairStripeIndex::Build(const StripeTable &table) {
+    width = table.Width();
+    pairs = width * (width - 1) / 2;
+    //扩缩容后旧的节点对可能不再有边，映射按当前布局重建，不随运行历史增长
+    ids.clear();
+    pair_count.clear();
+    //第一遍确定每个节点对的列表长度，第二遍按长度一次分配好后填入
+    positions.resize((size_t)table.StripeNum() * pairs);
+    size_t p = 0;
+    for (int s = 0; s < table.StripeNum(); s++) {
+        const int *members = table.Members(s);
+        for (int j = 0; j < width - 1; j++) {
+            for (int k = j + 1; k < width; k++) {
+                uint64_t key = Key(members[j], members[k]);
+                unordered_map<uint64_t, int>::iterator it = ids.find(key);
+                if (it == ids.end()) {
+                    it = ids.insert(make_pair(key, (int)ids.size())).first;
+                    pair_count.push_back(0);
+                }
+                pair_count[it->second]++;
+                positions[p++] = it->second;
+            }
+        }
+    }
+    //迁移会让部分列表变长，预留四分之一的余量
+    lists.Reset();
+    for (int i = 0; i < pair_count.size(); i++) {
+        lists.AddList(pair_count[i] + pair_count[i] / 4 + 1);
+    }
+    p = 0;
+    for (int s = 0; s < table.StripeNum(); s++) {
+        for (int j = 0; j < pairs; j++, p++) {
+            int id = positions[p];
+            positions[p] = lists.Size(id);
+            lists.PushBack(id, s);
+        }
+    }
+    active = 1;
+}
+
+void PairStripeIndex::Clear() {
+    active = 0;
+}
+
+/**
+ * @brief   节点对(a, b)的列表编号，第一次出现的节点对会新建一个列表
+ */
+int PairStripeIndex::Id(int a, int b) {
+    //先查找再插入，已有的节点对不会构造新的哈希表节点
+    uint64_t key = Key(a, b);
+    unordered_map<uint64_t, int>::iterator it = ids.find(key);
+    if (it != ids.end()) return it->second;
+    lists.AddList(1);
+    return ids.insert(make_pair(key, (int)ids.size())).first->second;
+}
+
+/**
+ * @brief   把条带stripe加入节点对(a, b)的列表，a、b分别是该条带的第j个与第k个块所在的节点
+ */
+void PairStripeIndex::Insert(int a, int b, int stripe, int j, int k) {
+    int id = Id(a, b);
+    Position(stripe, j, k) = lists.Size(id);
+    lists.PushBack(id, stripe);
+}
+
+/**
+ * @brief   把条带stripe从节点对(a, b)的列表中删除，用列表末尾的条带填补空位
+ */
+void PairStripeIndex::Remove(int a, int b, int stripe, int j, int k, const StripeTable &table) {
+    int id = Id(a, b);
+    int *list = lists.Data(id);
+    int last = list[lists.Size(id) - 1];
+    int pos = Position(stripe, j, k);
+    if (last != stripe) {
+        list[pos] = last;
+        Position(last, table.Find(last, a), table.Find(last, b)) = pos;
+    }
+    lists.PopBack(id);
+}
+
+void PairStripeIndex::Move(int stripe, int from, int to, const StripeTable &table) {
+    const int *members = table.Members(stripe);
+    int slot = table.Find(stripe, from);
+    for (int j = 0; j < width; j++) {
+        if (j == slot) continue;
+        Remove(from, members[j], stripe, slot, j, table);
+        Insert(to, members[j], stripe, slot, j);
+    }
+}
@@ -0,0 +1,76 @@
+/*********************************************************************************
+  * FileName:  pairindex.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  节点对到共享条带的索引，用于直接列出两个节点共同存放的条带
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_PAIRINDEX_H
+#define SUD_SCALE_SIMULATION_PAIRINDEX_H
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include "layout.h"
+using namespace std;
+
+/*
+ * 对每一对节点(a, b)记录同时在a和b上存放了块的条带，列表长度恰好等于G[a][b]。
+ * 只为实际有边的节点对建立列表，内存为O(S·n²)而不是O(D²)。
+ * 条带在每个列表中的下标记录在positions中，删除时用列表末尾的条带填补空位，块迁移时Move的代价为O(n²)。
+ * 各节点对的列表存放在ListArena中，每次Build时按当前布局重建节点对到列表编号的映射，
+ * 内存只与当前有边的节点对数有关，重复运行时复用已分配的内存
+ */
+class PairStripeIndex {
+public:
+    PairStripeIndex() : active(0), width(0), pairs(0) {}
+
+    /**
+     * @brief   根据当前的布局建立索引，已分配的内存会被复用
+     */
+    void Build(const StripeTable &table);
+    /**
+     * @brief   停止维护索引，保留已分配的内存
+     */
+    void Clear();
+
+    int Active() const { return active; }
+
+    /**
+     * @brief   节点a与节点b共享的条带，不存在时返回空列表
+     */
+    BlockList Stripes(int a, int b) const {
+        unordered_map<uint64_t, int>::const_iterator it = ids.find(Key(a, b));
+        return it == ids.end() ? BlockList(nullptr, 0) : lists.View(it->second);
+    }
+
+    /**
+     * @brief   条带stripe位于from的块将要迁移到to，需要在table更新之前调用
+     */
+    void Move(int stripe, int from, int to, const StripeTable &table);
+
+private:
+    static uint64_t Key(int a, int b) {
+        return a < b ? ((uint64_t)a << 32) | (uint32_t)b : ((uint64_t)b << 32) | (uint32_t)a;
+    }
+    /**
+     * @brief   条带中第j个块与第k个块（j < k）构成的节点对的序号，与Build中的遍历顺序相同
+     */
+    int PairSlot(int j, int k) const { return j * (2 * width - j - 1) / 2 + (k - j - 1); }
+    int &Position(int stripe, int j, int k) {
+        return positions[(size_t)stripe * pairs + (j < k ? PairSlot(j, k) : PairSlot(k, j))];
+    }
+    int Id(int a, int b);
+    void Insert(int a, int b, int stripe, int j, int k);
+    void Remove(int a, int b, int stripe, int j, int k, const StripeTable &table);
+
+    int active;
+    int width;
+    int pairs;                          //每个条带中的节点对数
+    unordered_map<uint64_t, int> ids;   //节点对到列表编号，每次Build时重建
+    ListArena lists;
+    vector<int> pair_count;             //Build时每个列表的长度
+    vector<int> positions;              //每个条带的各节点对在列表中的下标，Build的第一遍中暂存列表编号
+};
+
+#endif //SUD_SCALE_SIMULATION_PAIRINDEX_H
@@ -0,0 +1,73 @@
+/*********************************************************************************
+  * FileName:  parallel.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  常驻线程池，用于在一轮迁移内并行规划
+**********************************************************************************/
+
+#include "parallel.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads) : task(nullptr), task_count(0), generation(0), pending(0), stop(false) {
+    for (int i = 1; i < threads; i++) {
+        workers.push_back(thread(&ThreadPool::WorkerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mu);
+        stop = true;
+    }
+    start_cv.notify_all();
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::ParallelFor(int count, const function<void(int, int)> &fn) {
+    int parts = Size();
+    if (parts == 1 || count <= 1) {
+        fn(0, count);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mu);
+        task = &fn;
+        task_count = count;
+        pending = workers.size();
+        generation++;
+    }
+    start_cv.notify_all();
+    //当前线程负责第0段
+    fn(0, count / parts);
+    unique_lock<mutex> lock(mu);
+    done_cv.wait(lock, [this]() { return pending == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int id) {
+    int seen = 0;
+    while (true) {
+        const function<void(int, int)> *fn;
+        int count;
+        {
+            unique_lock<mutex> lock(mu);
+            start_cv.wait(lock, [this, seen]() { return stop || generation != seen; });
+            if (stop) return;
+            seen = generation;
+            fn = task;
+            count = task_count;
+        }
+        int parts = Size();
+        int begin = (long long)count * id / parts;
+        int end = (long long)count * (id + 1) / parts;
+        if (begin < end) (*fn)(begin, end);
+        {
+            lock_guard<mutex> lock(mu);
+            pending--;
+        }
+        done_cv.notify_one();
+    }
+}
@@ -0,0 +1,50 @@
+/*********************************************************************************
+  * FileName:  parallel.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  常驻线程池，用于在一轮迁移内并行规划
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_PARALLEL_H
+#define SUD_SCALE_SIMULATION_PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+using namespace std;
+
+/*
+ * 线程在构造时创建，之后每次ParallelFor只需唤醒，避免每轮迁移都创建线程。
+ * 调用ParallelFor的线程本身也参与计算
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int Size() const { return workers.size() + 1; }
+
+    /**
+     * @brief   把[0, count)均分为Size()段，并行执行fn(begin, end)，全部完成后返回
+     */
+    void ParallelFor(int count, const function<void(int, int)> &fn);
+
+private:
+    void WorkerLoop(int id);
+
+    vector<thread> workers;
+    mutex mu;
+    condition_variable start_cv;
+    condition_variable done_cv;
+    const function<void(int, int)> *task;
+    int task_count;
+    int generation;     //每次ParallelFor加一，工作线程据此判断是否有新任务
+    int pending;        //尚未完成当前任务的工作线程数
+    bool stop;
+};
+
+#endif //SUD_SCALE_SIMULATION_PARALLEL_H
@@ -0,0 +1,113 @@
+/*********************************************************************************
+  * FileName:  planwriter.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  迁移计划输出，记录按批交给后台线程写文件
+**********************************************************************************/
+
+#include <string.h>
+#include "planwriter.h"
+
+using namespace std;
+
+static const char g_PlanMagic[8] = {'S', 'U', 'D', 'P', 'L', 'A', 'N', '\0'};
+static const uint32_t g_PlanVersion = 1;
+
+PlanWriter::PlanWriter() : file(nullptr), format(PLAN_FORMAT_CSV), count(0), closing(false), io_error(0) {
+}
+
+PlanWriter::~PlanWriter() {
+    Close();
+}
+
+int PlanWriter::Open(const string &path, int plan_format) {
+    Close();
+    file = fopen(path.c_str(), plan_format == PLAN_FORMAT_BINARY ? "wb" : "w");
+    if (file == nullptr) return -1;
+    format = plan_format;
+    count = 0;
+    closing = false;
+    io_error = 0;
+    if (format == PLAN_FORMAT_BINARY) {
+        uint32_t header[2] = {g_PlanVersion, (uint32_t)sizeof(MoveRecord)};
+        if (fwrite(g_PlanMagic, 1, sizeof(g_PlanMagic), file) != sizeof(g_PlanMagic) ||
+            fwrite(header, sizeof(uint32_t), 2, file) != 2) {
+            fclose(file);
+            file = nullptr;
+            remove(path.c_str());
+            return -1;
+        }
+    } else {
+        fputs("phase,stripe,from,to\n", file);
+    }
+    batch.reserve(kBatchSize);
+    writer = thread(&PlanWriter::WriterLoop, this);
+    return 0;
+}
+
+int PlanWriter::Close() {
+    if (file == nullptr) return 0;
+    if (!batch.empty()) Submit();
+    {
+        lock_guard<mutex> lock(mu);
+        closing = true;
+    }
+    pending_cv.notify_one();
+    writer.join();
+    if (fclose(file) != 0) io_error = 1;
+    file = nullptr;
+    return io_error ? -1 : 0;
+}
+
+/**
+ * @brief   把当前批次交给后台线程，并换上一个空批次
+ */
+void PlanWriter::Submit() {
+    unique_lock<mutex> lock(mu);
+    space_cv.wait(lock, [this]() { return pending.size() < kMaxPending; });
+    pending.push_back(vector<MoveRecord>());
+    pending.back().swap(batch);
+    if (!spare.empty()) {
+        batch.swap(spare.back());
+        spare.pop_back();
+    } else {
+        batch.reserve(kBatchSize);
+    }
+    lock.unlock();
+    pending_cv.notify_one();
+}
+
+void PlanWriter::WriterLoop() {
+    vector<MoveRecord> records;
+    while (true) {
+        {
+            unique_lock<mutex> lock(mu);
+            if (records.capacity() > 0) {
+                //上一批已经写出，把内存还给模拟线程
+                records.clear();
+                spare.push_back(vector<MoveRecord>());
+                spare.back().swap(records);
+            }
+            pending_cv.wait(lock, [this]() { return closing || !pending.empty(); });
+            if (pending.empty()) return;
+            records.swap(pending.front());
+            pending.pop_front();
+        }
+        space_cv.notify_one();
+        WriteBatch(records);
+    }
+}
+
+void PlanWriter::WriteBatch(const vector<MoveRecord> &records) {
+    if (format == PLAN_FORMAT_BINARY) {
+        if (fwrite(records.data(), sizeof(MoveRecord), records.size(), file) != records.size())
+            io_error = 1;
+        return;
+    }
+    static const char *phase_name[] = {"expand", "shrink", "rebalance"};
+    for (size_t i = 0; i < records.size(); i++) {
+        const MoveRecord &r = records[i];
+        if (fprintf(file, "%s,%d,%d,%d\n", phase_name[r.phase], r.stripe, r.from, r.to) < 0)
+            io_error = 1;
+    }
+}
@@ -0,0 +1,98 @@
+/*********************************************************************************
+  * FileName:  planwriter.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  迁移计划输出，记录按批交给后台线程写文件
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_PLANWRITER_H
+#define SUD_SCALE_SIMULATION_PLANWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+enum PlanFormat {
+    PLAN_FORMAT_CSV,
+    PLAN_FORMAT_BINARY
+};
+
+/*迁移发生的阶段，虚拟扩容的重分布中扩容与缩容两个阶段都会出现，直接重分布只有PHASE_REBALANCE*/
+enum MovePhase {
+    PHASE_EXPAND,
+    PHASE_SHRINK,
+    PHASE_REBALANCE
+};
+
+/*
+ * 一次迁移：把条带stripe在from节点上的块迁移到to节点。
+ * 二进制格式为8字节魔数"SUDPLAN"、uint32版本号、uint32记录长度，之后依次是每条记录的4个int32，
+ * 均按本机字节序写入（x86上为小端），在其他字节序的机器上读取时需要转换
+ */
+struct MoveRecord {
+    int32_t phase;
+    int32_t stripe;
+    int32_t from;
+    int32_t to;
+};
+
+/*
+ * Record只把记录追加到当前批次，批次写满后交给后台线程，模拟线程不会因为写文件而阻塞，
+ * 只有后台线程积压的批次过多时才会等待
+ */
+class PlanWriter {
+public:
+    PlanWriter();
+    ~PlanWriter();
+    PlanWriter(const PlanWriter &) = delete;
+    PlanWriter &operator=(const PlanWriter &) = delete;
+
+    /**
+     * @brief   打开输出文件并写入文件头，启动后台线程
+     * @return  成功返回0，无法打开文件返回-1
+     */
+    int Open(const string &path, int plan_format);
+    /**
+     * @brief   写出剩余的记录并关闭文件
+     * @return  全部写入成功返回0，出现写错误返回-1
+     */
+    int Close();
+    int IsOpen() const { return file != nullptr; }
+    long long Count() const { return count; }
+
+    void Record(int phase, int stripe, int from, int to) {
+        MoveRecord r = {phase, stripe, from, to};
+        batch.push_back(r);
+        count++;
+        if (batch.size() >= kBatchSize) Submit();
+    }
+
+private:
+    static const size_t kBatchSize = 1 << 16;
+    static const size_t kMaxPending = 4;    //后台线程最多积压的批次数
+
+    void Submit();
+    void WriterLoop();
+    void WriteBatch(const vector<MoveRecord> &records);
+
+    FILE *file;
+    int format;
+    long long count;
+    vector<MoveRecord> batch;               //模拟线程正在填充的批次
+    deque<vector<MoveRecord> > pending;     //等待后台线程写出的批次
+    vector<vector<MoveRecord> > spare;      //已写出的批次，留待复用内存
+    mutex mu;
+    condition_variable pending_cv;          //有新批次或需要关闭
+    condition_variable space_cv;            //积压的批次减少
+    thread writer;
+    bool closing;
+    int io_error;
+};
+
+#endif //SUD_SCALE_SIMULATION_PLANWRITER_H
@@ -0,0 +1,100 @@
+/*********************************************************************************
+  * FileName:  recovery.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  单节点故障时的恢复读负载模拟
+**********************************************************************************/
+
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include "recovery.h"
+#include "parallel.h"
+
+using namespace std;
+
+/**
+ * @brief   计算一个节点故障时各存活节点的读负载
+ * @param   load    长度为disk_num的临时数组，由调用者提供以便在多次故障之间复用
+ */
+static void SimulateFailure(const DiskBlockSet &disks, const StripeTable &table, int disk_num, int k,
+                            int failed, vector<int> &load, FailureLoad &out) {
+    fill(load.begin(), load.end(), 0);
+    BlockList lost = disks[failed];
+    int width = table.Width();
+    vector<int> helpers;
+    helpers.reserve(width);
+    for (int i = 0; i < lost.size(); i++) {
+        const int *members = table.Members(lost[i]);
+        helpers.clear();
+        for (int j = 0; j < width; j++) {
+            if (members[j] != failed) helpers.push_back(members[j]);
+        }
+        //选出读负载最小的k个成员
+        int pick = min(k, (int)helpers.size());
+        partial_sort(helpers.begin(), helpers.begin() + pick, helpers.end(), [&load](int a, int b) {
+            return load[a] != load[b] ? load[a] < load[b] : a < b;
+        });
+        for (int j = 0; j < pick; j++) load[helpers[j]]++;
+    }
+    out.failed = failed;
+    out.lost_blocks = lost.size();
+    out.bottleneck = 0;
+    out.bottleneck_disk = -1;
+    for (int i = 0; i < disk_num; i++) {
+        if (load[i] > out.bottleneck) {
+            out.bottleneck = load[i];
+            out.bottleneck_disk = i;
+        }
+    }
+    long long total = (long long)k * lost.size();
+    out.lower_bound = disk_num > 1 ? (int)((total + disk_num - 2) / (disk_num - 1)) : 0;
+}
+
+void AnalyzeRecovery(const DiskBlockSet &disks, const StripeTable &table, int disk_num, int k,
+                     const vector<int> &failed, int threads, RecoveryResult &res) {
+    res = RecoveryResult();
+    res.disk_num = disk_num;
+    res.failures.resize(failed.size());
+    if (threads <= 0) {
+        threads = thread::hardware_concurrency();
+        threads = threads > 0 ? threads : 1;
+    }
+    threads = min(threads, max((int)failed.size(), 1));
+    ThreadPool pool(threads);
+    pool.ParallelFor(failed.size(), [&](int begin, int end) {
+        vector<int> load(disk_num);
+        for (int i = begin; i < end; i++) {
+            SimulateFailure(disks, table, disk_num, k, failed[i], load, res.failures[i]);
+        }
+    });
+    for (int i = 0; i < res.failures.size(); i++) {
+        res.mean_bottleneck += res.failures[i].bottleneck;
+        res.mean_lower_bound += res.failures[i].lower_bound;
+        if (res.worst == -1 || res.failures[i].bottleneck > res.failures[res.worst].bottleneck)
+            res.worst = i;
+    }
+    if (!res.failures.empty()) {
+        res.mean_bottleneck /= res.failures.size();
+        res.mean_lower_bound /= res.failures.size();
+    }
+}
+
+/**
+ * @brief   输出故障恢复的分析结果
+ * @param   detail  为1时逐个输出每次故障
+ */
+void PrintRecoveryResult(const char *title, const RecoveryResult &res, int detail) {
+    cout << title << "（" << res.disk_num << "个节点，" << res.failures.size() << "种单节点故障）：" << endl;
+    if (res.failures.empty()) return;
+    if (detail) {
+        for (int i = 0; i < res.failures.size(); i++) {
+            const FailureLoad &f = res.failures[i];
+            cout << "  节点" << f.failed << "故障：恢复" << f.lost_blocks << "块，最大读负载" << f.bottleneck
+                 << "（节点" << f.bottleneck_disk << "），下界" << f.lower_bound << endl;
+        }
+    }
+    const FailureLoad &w = res.failures[res.worst];
+    cout << "  平均最大读负载" << res.mean_bottleneck << "，平均下界" << res.mean_lower_bound << "，最坏情况为节点"
+         << w.failed << "故障时的" << w.bottleneck << endl;
+}
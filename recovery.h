@@ -0,0 +1,46 @@
+/*********************************************************************************
+  * FileName:  recovery.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  单节点故障时的恢复读负载模拟
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_RECOVERY_H
+#define SUD_SCALE_SIMULATION_RECOVERY_H
+
+#include <vector>
+#include "layout.h"
+using namespace std;
+
+/*
+ * 节点f故障后，f上的每个块都要从所在条带的其余n-1个块中读取k个来恢复。
+ * 每个块依次选择当前读负载最小的k个存活节点（负载相同时取节点号小的），
+ * 恢复时间由读负载最大的节点决定
+ */
+
+/*一个节点故障时的恢复情况*/
+struct FailureLoad {
+    int failed = 0;         //故障节点
+    int lost_blocks = 0;    //需要恢复的块数
+    int bottleneck = 0;     //存活节点中最大的读负载
+    int bottleneck_disk = -1;
+    int lower_bound = 0;    //读负载均匀分布在所有存活节点上时的最大读负载
+};
+
+struct RecoveryResult {
+    int disk_num = 0;
+    vector<FailureLoad> failures;
+    double mean_bottleneck = 0;
+    double mean_lower_bound = 0;
+    int worst = -1;         //最大读负载最大的一次故障在failures中的下标
+};
+
+/**
+ * @brief   依次模拟failed中的每个节点单独故障，不同故障之间互不影响，用threads个线程并行计算
+ * @param   disk_num    参与分析的节点数，节点号不小于disk_num的节点视为不存在
+ */
+void AnalyzeRecovery(const DiskBlockSet &disks, const StripeTable &table, int disk_num, int k,
+                     const vector<int> &failed, int threads, RecoveryResult &res);
+void PrintRecoveryResult(const char *title, const RecoveryResult &res, int detail);
+
+#endif //SUD_SCALE_SIMULATION_RECOVERY_H
@@ -0,0 +1,61 @@
+/*********************************************************************************
+  * FileName:  rng.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  计数器型随机数发生器，第i个随机数只由种子与i决定，结果可按种子精确复现
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_RNG_H
+#define SUD_SCALE_SIMULATION_RNG_H
+
+#include <stdint.h>
+
+/*
+ * 第i个随机数为Mix(key, i)，key由种子经过一轮混合得到。没有需要推进的内部状态，
+ * 生成一个随机数只需要几次乘法与移位，并且只要记下种子与计数器就能从任意位置重放
+ */
+class CounterRng {
+public:
+    CounterRng() : key(0), counter(0) {}
+
+    void Seed(uint64_t seed) {
+        key = Finalize(seed + 0x9E3779B97F4A7C15ULL);
+        counter = 0;
+    }
+    uint64_t Counter() const { return counter; }
+    void SetCounter(uint64_t value) { counter = value; }
+
+    uint64_t Next() { return Mix(key, counter++); }
+    /**
+     * @brief   [0, range)内均匀分布的整数，采用Lemire的乘法取高位法，拒绝采样消除偏差
+     */
+    uint32_t Below(uint32_t range) {
+        uint64_t m = (uint64_t)(uint32_t)Next() * range;
+        uint32_t low = (uint32_t)m;
+        if (low < range) {
+            uint32_t threshold = (0U - range) % range;
+            while (low < threshold) {
+                m = (uint64_t)(uint32_t)Next() * range;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    static uint64_t Mix(uint64_t key, uint64_t index) {
+        return Finalize(key ^ ((index + 1) * 0x9E3779B97F4A7C15ULL));
+    }
+
+private:
+    /*SplitMix64的混合函数*/
+    static uint64_t Finalize(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t key;
+    uint64_t counter;
+};
+
+#endif //SUD_SCALE_SIMULATION_RNG_H
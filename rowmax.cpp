@@ -0,0 +1,70 @@
+/*********************************************************************************
+  * FileName:  rowmax.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  增量维护邻接矩阵若干行的最大值，用于扩容时快速找到瓶颈节点
+**********************************************************************************/
+
+#include "rowmax.h"
+
+using namespace std;
+
+void RowMaxTracker::Build(const AdjacencyMatrix &G, int track_rows, int track_cols, const vector<double> *bw) {
+    graph = &G;
+    weights = bw;
+    rows = track_rows;
+    cols = track_cols;
+    heap.resize((size_t)rows * cols);
+    pos.resize((size_t)rows * cols);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            heap[(size_t)r * cols + c] = c;
+            pos[(size_t)r * cols + c] = c;
+        }
+        for (int k = cols / 2 - 1; k >= 0; k--) {
+            SiftDown(r, k);
+        }
+    }
+}
+
+void RowMaxTracker::Update(int row, int col) {
+    if (!Tracks(row, col)) return;
+    int k = pos[(size_t)row * cols + col];
+    SiftUp(row, k);
+    SiftDown(row, pos[(size_t)row * cols + col]);
+}
+
+void RowMaxTracker::Swap(int row, int k1, int k2) {
+    int *h = &heap[(size_t)row * cols];
+    int *p = &pos[(size_t)row * cols];
+    int c1 = h[k1];
+    int c2 = h[k2];
+    h[k1] = c2;
+    h[k2] = c1;
+    p[c2] = k1;
+    p[c1] = k2;
+}
+
+void RowMaxTracker::SiftUp(int row, int k) {
+    const int *h = &heap[(size_t)row * cols];
+    while (k > 0) {
+        int parent = (k - 1) / 2;
+        if (!Before(row, h[k], h[parent])) break;
+        Swap(row, k, parent);
+        k = parent;
+    }
+}
+
+void RowMaxTracker::SiftDown(int row, int k) {
+    const int *h = &heap[(size_t)row * cols];
+    while (true) {
+        int best = k;
+        int left = 2 * k + 1;
+        int right = left + 1;
+        if (left < cols && Before(row, h[left], h[best])) best = left;
+        if (right < cols && Before(row, h[right], h[best])) best = right;
+        if (best == k) break;
+        Swap(row, k, best);
+        k = best;
+    }
+}
@@ -0,0 +1,73 @@
+/*********************************************************************************
+  * FileName:  rowmax.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  增量维护邻接矩阵若干行的最大值，用于扩容时快速找到瓶颈节点
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_ROWMAX_H
+#define SUD_SCALE_SIMULATION_ROWMAX_H
+
+#include <vector>
+#include <algorithm>
+#include "graph.h"
+using namespace std;
+
+/*
+ * 为邻接矩阵的前rows行各维护一个带下标的最大堆，堆中元素为前cols列的列号。
+ * 边数更大的列优先，边数相同时列号小的优先，与从左到右扫描取第一个最大值的结果一致。
+ * 邻接矩阵中一个元素改变后调用Update，代价为O(logD)，查询瓶颈节点为O(1)
+ */
+class RowMaxTracker {
+public:
+    RowMaxTracker() : graph(nullptr), weights(nullptr), rows(0), cols(0) {}
+
+    /**
+     * @brief   根据邻接矩阵当前的值建堆
+     * @param   bw  不为空时按恢复时间G(row, col) / min(bw[row], bw[col])比较，调用者需保证其在跟踪期间有效
+     */
+    void Build(const AdjacencyMatrix &G, int track_rows, int track_cols, const vector<double> *bw = nullptr);
+    /**
+     * @brief   停止跟踪，保留已分配的内存
+     */
+    void Clear() { rows = 0; cols = 0; graph = nullptr; weights = nullptr; }
+
+    int Active() const { return graph != nullptr; }
+    int Tracks(int row, int col) const { return row < rows && col < cols; }
+
+    /**
+     * @brief   G(row, col)已经改变，调整该行的堆
+     */
+    void Update(int row, int col);
+
+    int ArgMax(int row) const { return heap[(size_t)row * cols]; }
+    edge_t Max(int row) const { return graph->Get(row, ArgMax(row)); }
+
+private:
+    //列a是否应排在列b之前
+    bool Before(int row, int a, int b) const {
+        edge_t va = graph->Get(row, a);
+        edge_t vb = graph->Get(row, b);
+        if (weights != nullptr) {
+            //va / wa与vb / wb交叉相乘比较，避免除法
+            double wa = min((*weights)[row], (*weights)[a]);
+            double wb = min((*weights)[row], (*weights)[b]);
+            double ta = va * wb;
+            double tb = vb * wa;
+            return ta > tb || (ta == tb && a < b);
+        }
+        return va > vb || (va == vb && a < b);
+    }
+    void SiftUp(int row, int k);
+    void SiftDown(int row, int k);
+    void Swap(int row, int k1, int k2);
+
+    const AdjacencyMatrix *graph;
+    const vector<double> *weights;  //各节点的带宽，为空时按边数比较
+    int rows;
+    int cols;
+    vector<int> heap;   //heap[row*cols+k]为第row行堆中第k个元素的列号
+    vector<int> pos;    //pos[row*cols+col]为第col列在第row行堆中的位置
+};
+
+#endif //SUD_SCALE_SIMULATION_ROWMAX_H
@@ -0,0 +1,247 @@
+/*********************************************************************************
+  * FileName:  simd.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  邻接矩阵热点循环的向量化实现，运行时按CPU支持的指令集选择
+**********************************************************************************/
+
+#include "simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SUD_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/*标量实现，同时作为非x86平台与尾部元素的处理方法*/
+static edge_t RowArgMaxScalar(const edge_t *row, int len, int &arg) {
+    edge_t best = 0;
+    arg = 0;
+    for (int j = 0; j < len; j++) {
+        if (row[j] > best) {
+            best = row[j];
+            arg = j;
+        }
+    }
+    return best;
+}
+
+static bool AnyAtLeastScalar(const edge_t *row, const int *cols, int count, int skip, edge_t limit) {
+    for (int m = 0; m < count; m++) {
+        if (cols[m] == skip) continue;
+        if (row[cols[m]] >= limit) return true;
+    }
+    return false;
+}
+
+#ifdef SUD_SIMD_X86
+
+#ifdef SUD_EDGE_COUNTER_16
+#define SUD_MAX128 _mm_max_epu16
+#define SUD_CMPEQ128 _mm_cmpeq_epi16
+#define SUD_SET128 _mm_set1_epi16
+#define SUD_MAX256 _mm256_max_epu16
+#define SUD_CMPEQ256 _mm256_cmpeq_epi16
+#define SUD_SET256 _mm256_set1_epi16
+#else
+#define SUD_MAX128 _mm_max_epu32
+#define SUD_CMPEQ128 _mm_cmpeq_epi32
+#define SUD_SET128 _mm_set1_epi32
+#define SUD_MAX256 _mm256_max_epu32
+#define SUD_CMPEQ256 _mm256_cmpeq_epi32
+#define SUD_SET256 _mm256_set1_epi32
+#endif
+
+/*
+ * 向量化的行最大值分两遍：第一遍求最大值，第二遍找到第一个等于最大值的位置。
+ * 两遍都是顺序访问，第二遍通常在很靠前的位置就结束
+ */
+__attribute__((target("sse4.1")))
+static edge_t RowArgMaxSse41(const edge_t *row, int len, int &arg) {
+    const int lanes = 16 / sizeof(edge_t);
+    int j = 0;
+    __m128i vmax = _mm_setzero_si128();
+    for (; j + lanes <= len; j += lanes) {
+        vmax = SUD_MAX128(vmax, _mm_loadu_si128((const __m128i *)(row + j)));
+    }
+    edge_t buf[16 / sizeof(edge_t)];
+    _mm_storeu_si128((__m128i *)buf, vmax);
+    edge_t best = 0;
+    for (int i = 0; i < lanes; i++) {
+        best = buf[i] > best ? buf[i] : best;
+    }
+    for (int i = j; i < len; i++) {
+        best = row[i] > best ? row[i] : best;
+    }
+    __m128i target = SUD_SET128(best);
+    for (j = 0; j + lanes <= len; j += lanes) {
+        int mask = _mm_movemask_epi8(SUD_CMPEQ128(_mm_loadu_si128((const __m128i *)(row + j)), target));
+        if (mask != 0) {
+            arg = j + __builtin_ctz(mask) / sizeof(edge_t);
+            return best;
+        }
+    }
+    for (; j < len; j++) {
+        if (row[j] == best) {
+            arg = j;
+            return best;
+        }
+    }
+    arg = 0;
+    return best;
+}
+
+__attribute__((target("avx2")))
+static edge_t RowArgMaxAvx2(const edge_t *row, int len, int &arg) {
+    const int lanes = 32 / sizeof(edge_t);
+    int j = 0;
+    //两个累加器交替使用，隐藏max指令的延迟
+    __m256i vmax0 = _mm256_setzero_si256();
+    __m256i vmax1 = _mm256_setzero_si256();
+    for (; j + 2 * lanes <= len; j += 2 * lanes) {
+        vmax0 = SUD_MAX256(vmax0, _mm256_loadu_si256((const __m256i *)(row + j)));
+        vmax1 = SUD_MAX256(vmax1, _mm256_loadu_si256((const __m256i *)(row + j + lanes)));
+    }
+    for (; j + lanes <= len; j += lanes) {
+        vmax0 = SUD_MAX256(vmax0, _mm256_loadu_si256((const __m256i *)(row + j)));
+    }
+    vmax0 = SUD_MAX256(vmax0, vmax1);
+    edge_t buf[32 / sizeof(edge_t)];
+    _mm256_storeu_si256((__m256i *)buf, vmax0);
+    edge_t best = 0;
+    for (int i = 0; i < lanes; i++) {
+        best = buf[i] > best ? buf[i] : best;
+    }
+    for (int i = j; i < len; i++) {
+        best = row[i] > best ? row[i] : best;
+    }
+    __m256i target = SUD_SET256(best);
+    for (j = 0; j + lanes <= len; j += lanes) {
+        int mask = _mm256_movemask_epi8(SUD_CMPEQ256(_mm256_loadu_si256((const __m256i *)(row + j)), target));
+        if (mask != 0) {
+            arg = j + __builtin_ctz(mask) / sizeof(edge_t);
+            return best;
+        }
+    }
+    for (; j < len; j++) {
+        if (row[j] == best) {
+            arg = j;
+            return best;
+        }
+    }
+    arg = 0;
+    return best;
+}
+
+/*
+ * SSE4.1没有gather，每次用标量读取4个条带成员对应的边数后一起比较，计数器宽度为16位时同样适用。
+ * 等于skip的成员被掩码屏蔽，不足4个的尾部按标量处理
+ */
+__attribute__((target("sse4.1")))
+static bool AnyAtLeastSse41(const edge_t *row, const int *cols, int count, int skip, edge_t limit) {
+    const __m128i vskip = _mm_set1_epi32(skip);
+    const __m128i vlimit = _mm_set1_epi32((int)limit);
+    int m = 0;
+    for (; m + 4 <= count; m += 4) {
+        __m128i idx = _mm_loadu_si128((const __m128i *)(cols + m));
+        __m128i value = _mm_setr_epi32((int)row[cols[m]], (int)row[cols[m + 1]], (int)row[cols[m + 2]],
+                                       (int)row[cols[m + 3]]);
+        //无符号比较value >= limit等价于max(value, limit) == value
+        __m128i ge = _mm_cmpeq_epi32(_mm_max_epu32(value, vlimit), value);
+        if (_mm_movemask_epi8(_mm_andnot_si128(_mm_cmpeq_epi32(idx, vskip), ge)) != 0) return true;
+    }
+    return AnyAtLeastScalar(row, cols + m, count - m, skip, limit);
+}
+
+#ifndef SUD_EDGE_COUNTER_16
+/*
+ * 用gather一次取出8个条带成员对应的边数。条带成员不足8个的部分与等于skip的成员被掩码屏蔽，
+ * 屏蔽的通道不会访问内存。成员较少时gather的启动开销大于收益，直接使用标量实现
+ */
+__attribute__((target("avx2")))
+static bool AnyAtLeastAvx2(const edge_t *row, const int *cols, int count, int skip, edge_t limit) {
+    if (count < 8) {
+        return AnyAtLeastScalar(row, cols, count, skip, limit);
+    }
+    const __m256i lane_id = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i vskip = _mm256_set1_epi32(skip);
+    const __m256i vlimit = _mm256_set1_epi32((int)limit);
+    for (int m = 0; m < count; m += 8) {
+        __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - m), lane_id);
+        __m256i idx = _mm256_maskload_epi32(cols + m, valid);
+        __m256i mask = _mm256_andnot_si256(_mm256_cmpeq_epi32(idx, vskip), valid);
+        __m256i value = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)row, idx, mask, 4);
+        //无符号比较value >= limit等价于max(value, limit) == value
+        __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(value, vlimit), value);
+        if (_mm256_movemask_epi8(_mm256_and_si256(ge, mask)) != 0) return true;
+    }
+    return false;
+}
+#endif
+
+#endif //SUD_SIMD_X86
+
+typedef edge_t (*RowArgMaxFunc)(const edge_t *, int, int &);
+typedef bool (*AnyAtLeastFunc)(const edge_t *, const int *, int, int, edge_t);
+
+static int g_SimdLevel = SIMD_SCALAR;
+static RowArgMaxFunc g_RowArgMax = RowArgMaxScalar;
+static AnyAtLeastFunc g_AnyAtLeast = AnyAtLeastScalar;
+
+int DetectSimdLevel() {
+#ifdef SUD_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SIMD_SSE41;
+#endif
+    return SIMD_SCALAR;
+}
+
+int SetSimdLevel(int level) {
+    int supported = DetectSimdLevel();
+    level = level < supported ? level : supported;
+    g_SimdLevel = SIMD_SCALAR;
+    g_RowArgMax = RowArgMaxScalar;
+    g_AnyAtLeast = AnyAtLeastScalar;
+#ifdef SUD_SIMD_X86
+    if (level >= SIMD_SSE41) {
+        g_SimdLevel = SIMD_SSE41;
+        g_RowArgMax = RowArgMaxSse41;
+        g_AnyAtLeast = AnyAtLeastSse41;
+    }
+    if (level >= SIMD_AVX2) {
+        g_SimdLevel = SIMD_AVX2;
+        g_RowArgMax = RowArgMaxAvx2;
+        //16位计数器不能用32位gather读取，最优解检查仍使用SSE4.1实现
+#ifndef SUD_EDGE_COUNTER_16
+        g_AnyAtLeast = AnyAtLeastAvx2;
+#endif
+    }
+#endif
+    return g_SimdLevel;
+}
+
+int GetSimdLevel() {
+    return g_SimdLevel;
+}
+
+const char *SimdLevelName(int level) {
+    switch (level) {
+        case SIMD_AVX2:
+            return "avx2";
+        case SIMD_SSE41:
+            return "sse4.1";
+        default:
+            return "scalar";
+    }
+}
+
+/*程序启动时选择CPU支持的最高指令集*/
+static int g_SimdInit = SetSimdLevel(SIMD_AVX2);
+
+edge_t RowArgMaxKernel(const edge_t *row, int len, int &arg) {
+    return g_RowArgMax(row, len, arg);
+}
+
+bool AnyAtLeastKernel(const edge_t *row, const int *cols, int count, int skip, edge_t limit) {
+    return g_AnyAtLeast(row, cols, count, skip, limit);
+}
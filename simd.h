@@ -0,0 +1,40 @@
+/*********************************************************************************
+  * FileName:  simd.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  邻接矩阵热点循环的向量化实现，运行时按CPU支持的指令集选择
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_SIMD_H
+#define SUD_SCALE_SIMULATION_SIMD_H
+
+#include "graph.h"
+
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE41 = 1,
+    SIMD_AVX2 = 2
+};
+
+/**
+ * @brief   当前CPU支持的最高指令集
+ */
+int DetectSimdLevel();
+/**
+ * @brief   指定使用的指令集，超过CPU支持的级别时取CPU支持的最高级别，返回实际使用的级别
+ */
+int SetSimdLevel(int level);
+int GetSimdLevel();
+const char *SimdLevelName(int level);
+
+/**
+ * @brief   求row[0..len)中的最大值及其下标，最大值相同时取下标最小的
+ */
+edge_t RowArgMaxKernel(const edge_t *row, int len, int &arg);
+/**
+ * @brief   判断row[cols[m]]（跳过cols[m]==skip的项）中是否存在不小于limit的值，
+            即把块放到该行对应的节点后是否会有边数超过理论最优解
+ */
+bool AnyAtLeastKernel(const edge_t *row, const int *cols, int count, int skip, edge_t limit);
+
+#endif //SUD_SCALE_SIMULATION_SIMD_H
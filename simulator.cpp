@@ -0,0 +1,1205 @@
+/*********************************************************************************
+  * FileName:  simulator.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  simulation of SUD Scale
+**********************************************************************************/
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+#include <assert.h>
+#include <math.h>
+#include "simulator.h"
+
+using namespace std;
+
+SUDSimulator::SUDSimulator() : disk_profile(nullptr), topology(nullptr), keep_index(0), plan_writer(nullptr), plan_record(nullptr),
+                               layout_file(nullptr) {
+    UpdateBounds();
+    moved_blocks = 0;
+    suboptimal_moves = 0;
+    fatal = 0;
+    sud_cost = 0;
+    random_cost = 0;
+    BindWidthImpl();
+}
+
+SUDSimulator::~SUDSimulator() {
+}
+
+void SUDSimulator::Reset(const SimConfig &config) {
+    cfg = config;
+    UpdateBounds();
+    moved_blocks = 0;
+    suboptimal_moves = 0;
+    fatal = 0;
+    sud_cost = 0;
+    random_cost = 0;
+    //未指定种子时与原实现一样使用当前时间，指定种子时结果可以复现
+    unsigned long long seed = cfg.seed;
+    if (seed == 0) {
+        seed = chrono::system_clock::now().time_since_epoch().count();
+    }
+    rng.Seed(seed);
+    BindWidthImpl();
+    stats.Reset();
+    //各节点的块列表与block_location由InitDisks重新建立，这里不预先分配，使用布局文件时不会再持有一份布局
+    G.Reset(0, cfg.triangular_graph);
+}
+
+/**
+ * @brief   清空各节点与各条带中的块，保留vector已分配的容量
+ */
+void SUDSimulator::ClearLayout() {
+    //运行过程中单个节点的块数一般不超过按最少节点数均分时的块数，次优解造成的少量超出由DiskBlockSet搬移处理
+    disks.Reset(cfg.disk_num_origin, (int)(cfg.TotalBlocks() / cfg.MinDiskNum()));
+    block_location.Reset(cfg.stripe_num, cfg.n, cfg.disk_num_origin);
+}
+
+/**
+ * @brief   把布局文件映射为block_location，并按其中的布局建立各节点的块列表
+ */
+void SUDSimulator::LoadLayout() {
+    int *data = layout_file->Map();
+    if (data == nullptr) {
+        //Open时已经映射成功过，这里失败只可能是地址空间或内存耗尽，无法继续模拟
+        cerr << "Error: 无法映射布局文件" << endl;
+        abort();
+    }
+    disks.Reset(cfg.disk_num_origin, (int)(cfg.TotalBlocks() / cfg.MinDiskNum()));
+    block_location.Attach(data, cfg.stripe_num, cfg.n, cfg.disk_num_origin);
+    for (int s = 0; s < cfg.stripe_num; s++) {
+        const int *members = block_location.Members(s);
+        for (int i = 0; i < cfg.n; i++) {
+            disks.Insert(members[i], s, i, block_location);
+        }
+    }
+}
+
+/**
+ * @brief   统计前disk_num个节点构成的邻接矩阵的最大值
+ */
+void SUDSimulator::CollectResult(SimResult &res, int disk_num) const {
+    res.optimal = optimal;
+    res.max_edge = 0;
+    for (int i = 0; i < disk_num; i++) {
+        int arg;
+        int row_max = G.RowArgMax(i, disk_num, arg);
+        res.max_edge = row_max > res.max_edge ? row_max : res.max_edge;
+    }
+    res.is_optimal = res.max_edge <= optimal ? 1 : 0;
+    res.optimal_time = optimal_time;
+    res.max_time = res.max_edge;
+    if (disk_profile != nullptr) {
+        //按恢复时间统计，并逐对检查边数是否超过该节点对的上限
+        res.max_time = 0;
+        res.is_optimal = 1;
+        for (int i = 0; i < disk_num; i++) {
+            for (int j = i + 1; j < disk_num; j++) {
+                edge_t e = G.Get(i, j);
+                res.max_time = max(res.max_time, e / min(disk_profile->Bandwidth(i), disk_profile->Bandwidth(j)));
+                if (e > min(edge_limit[i], edge_limit[j])) res.is_optimal = 0;
+            }
+        }
+    }
+    if (level_graph.Active()) {
+        res.topology_optimal = 1;
+        for (int l = 0; l < LEVEL_NUM; l++) {
+            level_graph.Worst(l, res.level_edge[l], res.level_limit[l]);
+            if (res.level_edge[l] > res.level_limit[l]) res.topology_optimal = 0;
+        }
+    }
+    res.moved_blocks = moved_blocks;
+    res.fatal = fatal;
+    res.sud_cost = sud_cost;
+    res.random_cost = random_cost;
+}
+
+const DiskBlockSet &SUDSimulator::GetDisks() const {
+    return disks;
+}
+
+const AdjacencyMatrix &SUDSimulator::GetGraph() const {
+    return G;
+}
+
+void SUDSimulator::SetPlanWriter(PlanWriter *writer) {
+    plan_writer = writer;
+}
+
+void SUDSimulator::SetPlanRecord(vector<MoveRecord> *record) {
+    plan_record = record;
+}
+
+void SUDSimulator::SetLayout(LayoutFile *layout) {
+    layout_file = layout;
+}
+
+void SUDSimulator::SetDiskProfile(const DiskProfile *profile) {
+    disk_profile = profile;
+    UpdateBounds();
+}
+
+void SUDSimulator::SetTopology(const Topology *topo) {
+    topology = topo;
+    level_graph.Reset(topo);
+    UpdateBounds();
+}
+
+/**
+ * @brief   前disk_num个节点各自应存放的块数。未设置节点配置时与原实现一样均分，否则按容量比例分配
+ */
+void SUDSimulator::ComputeQuota(int disk_num, vector<int> &out) const {
+    if (disk_profile == nullptr) {
+        out.assign(disk_num, (int)(cfg.TotalBlocks() / disk_num));
+    } else {
+        disk_profile->Quotas(disk_num, cfg.TotalBlocks(), out);
+    }
+}
+
+/**
+ * @brief   按cfg.disk_num_after_scale重新计算各节点应存放的块数与理想最优解。设置了节点配置时理想最优解
+            按恢复时间计算，每对节点的边数上限由两端的带宽决定。设置了拓扑时同时更新各层的上限
+ */
+void SUDSimulator::UpdateBounds() {
+    ComputeQuota(cfg.disk_num_after_scale, quota);
+    if (level_graph.Active())
+        level_graph.SetBounds(cfg.disk_num_after_scale, cfg.k, cfg.stripe_num, cfg.n);
+    if (disk_profile == nullptr) {
+        optimal = cfg.Optimal();
+        optimal_time = optimal;
+        return;
+    }
+    optimal_time = disk_profile->OptimalTime(cfg.disk_num_after_scale, cfg.k, quota);
+    disk_profile->EdgeLimits(cfg.disk_num_after_scale, optimal_time, edge_limit);
+    optimal = *max_element(edge_limit.begin(), edge_limit.end());
+}
+
+/**
+ * @brief   设置了节点配置时扩容中瓶颈节点按恢复时间选取，返回各节点的带宽；否则返回nullptr，按边数选取
+ */
+const vector<double> *SUDSimulator::BottleneckWeights() {
+    if (disk_profile == nullptr) return nullptr;
+    bottleneck_bw.resize(cfg.disk_num_after_scale);
+    for (int i = 0; i < cfg.disk_num_after_scale; i++) {
+        bottleneck_bw[i] = disk_profile->Bandwidth(i);
+    }
+    return &bottleneck_bw;
+}
+
+/**
+ * @brief   设置了节点配置时的ExceedsOptimal：disk与members中其他节点（跳过skip）之间是否有边数达到该节点对的上限
+ */
+bool SUDSimulator::ExceedsLimit(int disk, const int *members, int skip) const {
+    for (int m = 0; m < cfg.n; m++) {
+        int x = members[m];
+        if (x == skip) continue;
+        if (G.Get(disk, x) >= min(edge_limit[disk], edge_limit[x])) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief   在当前布局的前disk_num个节点上分析单节点故障，cfg.recovery_disk为-1时分析每个节点
+ */
+void SUDSimulator::AnalyzeFailures(int disk_num, RecoveryResult &res) const {
+    vector<int> failed;
+    if (cfg.recovery_disk >= 0) {
+        failed.push_back(cfg.recovery_disk);
+    } else {
+        for (int i = 0; i < disk_num; i++) failed.push_back(i);
+    }
+    AnalyzeRecovery(disks, block_location, disk_num, cfg.k, failed, cfg.recovery_threads, res);
+}
+
+/**
+ * @brief   把一次迁移交给迁移计划的输出与内存中的迁移计划
+ */
+void SUDSimulator::RecordMove(int phase, int stripe, int from, int to) {
+    if (plan_writer != nullptr)
+        plan_writer->Record(phase, stripe, from, to);
+    if (plan_record != nullptr) {
+        MoveRecord r = {phase, stripe, from, to};
+        plan_record->push_back(r);
+    }
+}
+
+SimResult SUDSimulator::Run() {
+    PhaseTimer timer(stats.total_ms);
+    SimResult res;
+    if (cfg.evaluation == 0) {
+        InitDisks();
+        InitGraph();
+        if (cfg.recovery) {
+            PhaseTimer recovery_timer(stats.recovery_ms);
+            AnalyzeFailures(cfg.disk_num_origin, res.recovery_before);
+        }
+        if (cfg.disk_num_origin < cfg.disk_num_after_scale) {
+            //执行扩容操作
+            SUDExpand();
+        } else if (cfg.disk_num_origin > cfg.disk_num_after_scale) {
+            //执行缩容操作
+            SUDShrink();
+        } else {
+            //执行数据重新分布操作
+            Redistribute();
+        }
+        if (cfg.recovery && fatal == 0) {
+            PhaseTimer recovery_timer(stats.recovery_ms);
+            AnalyzeFailures(cfg.disk_num_after_scale, res.recovery_after);
+        }
+    } else {
+        Evaluation();
+    }
+    CollectResult(res, cfg.disk_num_after_scale);
+    return res;
+}
+
+SimResult SUDSimulator::RunTimeline(vector<TimelineStep> &steps) {
+    PhaseTimer timer(stats.total_ms);
+    SimResult res;
+    steps.clear();
+    InitDisks();
+    InitGraph();
+    //pair_index在第一次扩容时建立，之后缩容中的迁移也通过MoveBlock更新它
+    keep_index = 1;
+    long long total_moved = 0;
+    for (int t = 0; t < cfg.timeline.size() && fatal == 0; t++) {
+        TimelineStep step;
+        step.disk_num_before = t == 0 ? cfg.disk_num_origin : cfg.disk_num_after_scale;
+        step.disk_num_after = cfg.timeline[t];
+        cfg.disk_num_origin = step.disk_num_before;
+        cfg.disk_num_after_scale = step.disk_num_after;
+        UpdateBounds();
+        moved_blocks = 0;
+        suboptimal_moves = 0;
+        if (cfg.verbose > VERBOSE_QUIET)
+            cout << "===== 第" << t + 1 << "步：" << step.disk_num_before << " -> " << step.disk_num_after << " =====" << endl;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (step.disk_num_before < step.disk_num_after) {
+            SUDExpand();
+        } else {
+            SUDShrink();
+        }
+        step.elapsed_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        SimResult step_res;
+        CollectResult(step_res, step.disk_num_after);
+        total_moved += moved_blocks;
+        step.optimal = step_res.optimal;
+        step.max_edge = step_res.max_edge;
+        step.is_optimal = step_res.is_optimal;
+        step.moved_blocks = moved_blocks;
+        step.suboptimal_moves = suboptimal_moves;
+        step.total_moved_blocks = total_moved;
+        steps.push_back(step);
+    }
+    keep_index = 0;
+    pair_index.Clear();
+    CollectResult(res, cfg.disk_num_after_scale);
+    res.moved_blocks = total_moved;
+    return res;
+}
+
+/*InitDisk中用于对节点中的块数排序*/
+bool cmp(pair<int, int> p1, pair<int, int> p2){
+    return p1.second < p2.second;
+}
+
+/**
+ * @brief   随机生成节点中的数据。采用的方法为，首先通过部分Fisher–Yates洗牌随机选择n个节点存放
+            第一个条带。之后每次选出块数最少的n个节点放置下一个条带（见PlaceByHeap）。因为
+            n、条带数、节点数之间满足整除关系，所以最终每个节点中的块数一定相同
+ **/
+void SUDSimulator::InitDisks() {
+    PhaseTimer timer(stats.init_disks_ms);
+    if (layout_file != nullptr) {
+        LoadLayout();
+        return;
+    }
+    vector<int> &vec_temp = shuffle_buf;
+    vec_temp.clear();
+    for (int i = 0; i < cfg.disk_num_origin; i++) {
+        vec_temp.push_back(i);
+    }
+    ClearLayout();
+    ComputeQuota(cfg.disk_num_origin, init_quota);
+    int cur_stripe_num = 0;
+    int quit_shuffle = 0;
+    while (true) {
+        //只洗出前n个位置：第i次从剩余的节点中均匀选一个换到位置i，vec_temp不必在条带之间复原
+        for (int i = 0; i < cfg.n; i++) {
+            int r = i + rng.Below(cfg.disk_num_origin - i);
+            swap(vec_temp[i], vec_temp[r]);
+            int select = vec_temp[i];
+            PlaceBlock(cur_stripe_num, i, select);
+            if (disks[select].size() >= init_quota[select]) {
+                quit_shuffle = 1;
+            }
+        }
+        cur_stripe_num++;
+        if (quit_shuffle == 1) break;
+    }
+    if (cfg.placement == 1) {
+        PlaceBySort(cur_stripe_num);
+    } else {
+        PlaceByHeap(cur_stripe_num);
+    }
+    if (cfg.debug == 1) {
+        cout << "===== InitDisks =====" << endl;
+        //测试
+        cout << "各节点中块数：" << endl;
+        for (int i = 0; i < cfg.disk_num_origin; i++) {
+            cout << disks[i].size() << " ";
+        }
+        cout << endl << endl;
+        cout << "各节点中的块号：" << endl;
+        for (int i = 0; i < cfg.disk_num_origin; i++) {
+            cout << "disk" << i << ": ";
+            for (int j = 0; j < disks[i].size(); j++) {
+                cout << disks[i][j] << " ";
+            }
+            cout << endl << endl;
+        }
+        //测试哈希表
+        cout << "测试哈希表：" << endl;
+        for (int i = 0; i < cfg.stripe_num; i++) {
+            cout << "stripe " << i << ": ";
+            for (int j = 0; j < block_location.Width(); j++) {
+                cout << block_location.Members(i)[j] << " ";
+            }
+            cout << endl;
+        }
+
+        cout << "===== end =====" << endl << endl;
+    }
+}
+
+/**
+ * @brief   原有的后期放置方法：每放置一个条带都按块数对所有节点排序，选出块数最少的n个节点。
+            时间复杂度为O(S·D·logD)，保留用于对比
+ * @param   cur_stripe_num  第一个尚未放置的条带号
+ */
+void SUDSimulator::PlaceBySort(int cur_stripe_num) {
+    /*完成了前期的shuffle，接下来按照每个节点中块数升序排序。思路为构建vector<pair<节点号, 块数> >，
+    然后根据块数排序*/
+    vector<pair<int, int> > pii;
+    while (cur_stripe_num < cfg.stripe_num) {
+        for (int i = 0; i < cfg.disk_num_origin; i++) {
+            pii.push_back(make_pair(i, disks[i].size() - init_quota[i]));
+        }
+        sort(pii.begin(), pii.end(), cmp);
+        for (int i = 0; i < cfg.n; i++) {
+            PlaceBlock(cur_stripe_num, i, pii[i].first);
+        }
+        cur_stripe_num++;
+        pii.clear();
+    }
+}
+
+/**
+ * @brief   基于最小堆的后期放置方法。堆中每个节点恰好出现一次，键为<块数, 节点号>，
+            每个条带弹出堆顶的n个节点（必然互不相同），放置后块数加一再压回堆中。
+            每个条带的代价为O(n·logD)，得到的各节点块数与排序方法相同
+ * @param   cur_stripe_num  第一个尚未放置的条带号
+ */
+void SUDSimulator::PlaceByHeap(int cur_stripe_num) {
+    vector<pair<int, int> > &heap = placement_heap;
+    heap.clear();
+    for (int i = 0; i < cfg.disk_num_origin; i++) {
+        heap.push_back(make_pair((int)disks[i].size() - init_quota[i], i));
+    }
+    greater<pair<int, int> > heap_cmp;
+    make_heap(heap.begin(), heap.end(), heap_cmp);
+    while (cur_stripe_num < cfg.stripe_num) {
+        //弹出的n个元素依次存放在heap的尾部
+        for (int i = 0; i < cfg.n; i++) {
+            pop_heap(heap.begin(), heap.end() - i, heap_cmp);
+        }
+        for (int i = 0; i < cfg.n; i++) {
+            pair<int, int> &top = heap[heap.size() - cfg.n + i];
+            PlaceBlock(cur_stripe_num, i, top.second);
+            top.first++;
+            push_heap(heap.begin(), heap.end() - cfg.n + i + 1, heap_cmp);
+        }
+        cur_stripe_num++;
+    }
+}
+
+/**
+ * @brief   把条带stripe的第slot个块放置到disk上，用于初始化数据
+ */
+void SUDSimulator::PlaceBlock(int stripe, int slot, int disk) {
+    block_location.Set(stripe, slot, disk);
+    disks.Insert(disk, stripe, slot, block_location);
+}
+
+/**
+ * @brief   把条带stripe位于from的块迁移到to，同时维护邻接矩阵、disks与block_location
+ */
+void SUDSimulator::MoveBlock(int stripe, int from, int to) {
+    const int *members = block_location.Members(stripe);
+    int slot = -1;
+    //对边进行增删调整
+    for (int j = 0; j < cfg.n; j++) {
+        if (members[j] == from) {
+            slot = j;
+            continue;
+        }
+        AddEdge(from, members[j], -1);
+        AddEdge(members[j], to, 1);
+    }
+    if (pair_index.Active()) {
+        pair_index.Move(stripe, from, to, block_location);
+    }
+    disks.Remove(from, stripe, slot, block_location);
+    block_location.Set(stripe, slot, to);
+    disks.Insert(to, stripe, slot, block_location);
+}
+
+/**
+ * @brief   修改节点a与节点b之间的边数，并同步更新瓶颈跟踪
+ */
+void SUDSimulator::AddEdge(int a, int b, int delta) {
+    SUD_STAT_ADD(stats, g_updates, 1);
+    G.Add(a, b, delta);
+    if (row_max.Active()) {
+        row_max.Update(a, b);
+        row_max.Update(b, a);
+    }
+    if (level_graph.Active())
+        level_graph.Add(a, b, delta);
+}
+
+/**
+ * @brief   根据随机生成的数据初始化图
+ */
+void SUDSimulator::InitGraph() {
+    PhaseTimer timer(stats.init_graph_ms);
+    (this->*init_graph_impl)();
+    if (level_graph.Active())
+        level_graph.Build(G, cfg.disk_num_origin);
+    if (cfg.verbose < VERBOSE_FULL) return;
+    if (cfg.evaluation == 0)
+        cout << "根据随机数据生成的邻接矩阵：" << '\n';
+    PrintGraph(cfg.disk_num_origin);
+    cout << '\n';
+}
+
+/**
+ * @brief   InitGraph的实现，N为0时按cfg.n循环
+ */
+template <int N>
+void SUDSimulator::InitGraphImpl() {
+    const int n = N > 0 ? N : cfg.n;
+    G.Reset(cfg.disk_num_origin, cfg.triangular_graph);
+    //根据block_location可以方便地知道哪些节点之间应该有边
+    for (int i = 0; i < cfg.stripe_num; i++) {
+        const int *members = block_location.Members(i);
+        for (int j = 0; j < n - 1; j++) {
+            for (int k = j + 1; k < n; k++) {
+                G.Add(members[j], members[k], 1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief   按cfg.n选择InitGraph、SelectTravelBlock与FindTargetDisk的实现。特化的条带长度
+            对应4+2、6+3、10+4、12+4等常用编码，以及默认的n=4
+ */
+void SUDSimulator::BindWidthImpl() {
+    switch (cfg.n) {
+        case 4: BindWidth<4>(); break;
+        case 6: BindWidth<6>(); break;
+        case 9: BindWidth<9>(); break;
+        case 14: BindWidth<14>(); break;
+        case 16: BindWidth<16>(); break;
+        default: BindWidth<0>(); break;
+    }
+}
+
+template <int N>
+void SUDSimulator::BindWidth() {
+    init_graph_impl = &SUDSimulator::InitGraphImpl<N>;
+    select_impl = &SUDSimulator::SelectTravelBlockImpl<N>;
+    find_impl = &SUDSimulator::FindTargetDiskImpl<N>;
+}
+
+/**
+ * @brief   把块放到节点disk后，disk与members中的其他节点（跳过skip）之间是否会有边数超过理论最优解
+ */
+template <int N>
+bool SUDSimulator::ExceedsOptimal(int disk, const int *members, int skip) const {
+    if (disk_profile != nullptr) return ExceedsLimit(disk, members, skip);
+    if (N > 0) return G.AnyAtLeastFixed<N>(disk, members, skip, optimal);
+    return G.AnyAtLeast(disk, members, cfg.n, skip, optimal);
+}
+
+/**
+ * @brief   输出前disk_num个节点构成的邻接矩阵，逐行输出而不刷新缓冲区
+ */
+void SUDSimulator::PrintGraph(int disk_num) const {
+    for (int i = 0; i < disk_num; i++) {
+        for (int j = 0; j < disk_num; j++) {
+            cout << G.Get(i, j) << " ";
+        }
+        cout << '\n';
+    }
+}
+
+/**
+ * @brief   扩缩容结束后按输出详细程度报告结果
+ * @param   title   完整输出时邻接矩阵的标题
+ */
+void SUDSimulator::ReportScaleResult(const char *title) const {
+    if (cfg.verbose == VERBOSE_QUIET) return;
+    if (cfg.verbose == VERBOSE_FULL) {
+        cout << title << '\n';
+        PrintGraph(cfg.disk_num_after_scale);
+    }
+    if (cfg.evaluation == 0) {
+        SimResult res;
+        CollectResult(res, cfg.disk_num_after_scale);
+        cout << "共迁移" << moved_blocks << "块，其中" << suboptimal_moves << "块采用次优解" << endl;
+        if (disk_profile != nullptr)
+            cout << "理想恢复时间为" << res.optimal_time << "，最大恢复时间为" << res.max_time << endl;
+        if (level_graph.Active()) {
+            cout << "主机间最紧的一对边数为" << res.level_edge[LEVEL_HOST] << "（上限" << res.level_limit[LEVEL_HOST]
+                 << "），机架间最紧的一对边数为" << res.level_edge[LEVEL_RACK] << "（上限" << res.level_limit[LEVEL_RACK] << "）";
+            cout << (res.topology_optimal ? "，均未超过上限" : "，超过了上限") << endl;
+        }
+        if (res.is_optimal == 1) {
+            cout << "得到理想最优解" << endl;
+        } else {
+            cout << "未能得到理想最优解" << endl;
+        }
+    }
+}
+
+/**
+ * @brief   从disk中选择一个将要被迁移到新节点（或布局文件中块数不足的原节点）的块，需要在SUDExpand中建立pair_index之后调用。
+            函数只读取模拟器状态，可以在多个线程中对不同的disk同时调用
+ * @param   disk    需要被迁移的块所在的节点
+ * @param   bottleneck_disk 与disk恢复形成瓶颈的节点
+ * @param   plan    若不为空，返回所采用方案的等级：PLAN_OPTIMAL、PLAN_TOPOLOGY、PLAN_B或PLAN_C
+ * @return  返回一个pair，pair的第一项为disk中要被迁移的块号，第二项为迁移目标节点
+ */
+pair<int, int> SUDSimulator::SelectTravelBlock(int disk, int bottleneck_disk, int *plan) const {
+    return (this->*select_impl)(disk, bottleneck_disk, plan);
+}
+
+template <int N>
+pair<int, int> SUDSimulator::SelectTravelBlockImpl(int disk, int bottleneck_disk, int *plan) const {
+    pair<int, int> plan_b = make_pair(-1, -1);//当最优解没有找到时，plan_b记录的是当采取非最优方案时的迁移目标节点
+    pair<int, int> plan_c = make_pair(-1, -1);
+    pair<int, int> plan_topology = make_pair(-1, -1);//不超过节点对的理论最优解但超过主机或机架上限的迁移中超出最少的
+    double topology_load = 0;
+    //只有与bottleneck_disk关联的块才可能被迁移，通过pair_index直接列出disk与bottleneck_disk共享的条带
+    BlockList candidates = pair_index.Stripes(disk, bottleneck_disk);
+    SUD_STAT_ADD(stats, select_calls, 1);
+    for (int i = 0; i < candidates.size(); i++) {
+        int stripe = candidates[i];
+        const int *vec_temp = block_location.Members(stripe);
+        //检查目标节点中是否有某个节点没有与当前块在同一条带的块
+        for (int t = 0; t < expand_targets.size(); t++) {
+            int j = expand_targets[t];
+            if (block_location.Contains(stripe, j)) {
+                //当前目标节点中已经存放了同一条带的块，这个节点无法作为目标节点
+                continue;
+            } else {
+                //当前目标节点中没有与i在同一条带的块
+                //检查当前目标节点上是否还有位置
+                if (disks[j].size() >= quota[j]) {
+                    //当前目标节点没有位置了
+                    plan_c = make_pair(stripe, j);
+                    continue;
+                } else {
+                    //当前目标节点上还有位置
+                    plan_b = make_pair(stripe, j);//当最优解无法找到，就放弃最后一个约束条件，采取次优解
+                    //检查假设把块迁移到这个目标节点后，传输时间是否超过理论最优解，即G[j][m] + 1 > optimal
+                    if (!ExceedsOptimal<N>(j, vec_temp, disk)) {
+                        //设置了拓扑时还要检查各层每对主机、机架之间的边数
+                        if (level_graph.Active()) {
+                            double load = level_graph.Load(disk, j, vec_temp, cfg.n);
+                            if (load > 1) {
+                                if (plan_topology.first == -1 || load < topology_load) {
+                                    plan_topology = make_pair(stripe, j);
+                                    topology_load = load;
+                                }
+                                continue;
+                            }
+                        }
+                        SUD_STAT_ADD(stats, select_scanned, i + 1);
+                        if (plan != nullptr) *plan = PLAN_OPTIMAL;
+                        return make_pair(stripe, j);
+                    }
+                }
+            }
+        }
+    }
+    //没有找到最优解，依次退而采用超过拓扑上限、超过理论最优解与目标节点已满的迁移
+    SUD_STAT_ADD(stats, select_scanned, candidates.size());
+    if (plan_topology.first != -1) {
+        if (plan != nullptr) *plan = PLAN_TOPOLOGY;
+        return plan_topology;
+    }
+    if (plan_b.first != -1) {
+        if (plan != nullptr) *plan = PLAN_B;
+        return plan_b;
+    }
+    //布局文件不均衡时目标节点的空位恰好等于需要迁出的块数，不能让块迁入已满的节点
+    if (cfg.external_layout) {
+        pair<int, int> spare = SelectSpareTarget<N>(disk);
+        if (spare.first != -1) plan_c = spare;
+    }
+    if (plan != nullptr) *plan = PLAN_C;
+    return plan_c;
+}
+
+/**
+ * @brief   在disk的全部块中寻找一个可以迁移到仍有空位的目标节点的块，优先选择不超过理论最优解的迁移，
+            用于与瓶颈节点共享的条带都找不到有空位的目标节点时
+ * @return  找不到时返回(-1, -1)
+ */
+template <int N>
+pair<int, int> SUDSimulator::SelectSpareTarget(int disk) const {
+    pair<int, int> fallback = make_pair(-1, -1);
+    BlockList blocks = disks[disk];
+    for (int i = 0; i < blocks.size(); i++) {
+        int stripe = blocks[i];
+        const int *members = block_location.Members(stripe);
+        for (int t = 0; t < expand_targets.size(); t++) {
+            int j = expand_targets[t];
+            if (block_location.Contains(stripe, j) || disks[j].size() >= quota[j]) continue;
+            if (!ExceedsOptimal<N>(j, members, disk)) return make_pair(stripe, j);
+            if (fallback.first == -1) fallback = make_pair(stripe, j);
+        }
+    }
+    return fallback;
+}
+
+/**
+ * @brief   并行规划一轮迁移：每个原节点基于本轮开始时的G、row_max与pair_index选出候选迁移，
+            规划期间不修改任何状态，因此结果与线程数无关
+ */
+void SUDSimulator::PlanRound(int round) {
+    round_plan.resize(cfg.disk_num_origin);
+    plan_pool->ParallelFor(cfg.disk_num_origin, [this, round](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            PlannedMove &move = round_plan[i];
+            if (round >= travel[i]) continue;
+            move.bottleneck = row_max.ArgMax(i);
+            pair<int, int> travel_pair = SelectTravelBlock(i, move.bottleneck, &move.plan);
+            move.stripe = travel_pair.first;
+            move.target = travel_pair.second;
+        }
+    });
+}
+
+/**
+ * @brief   合并阶段检查disk的候选迁移在本轮前面的迁移执行之后是否仍然成立
+ * @return  瓶颈节点未变且仍存放该条带的块，目标节点仍未存放该条带的块、仍有空位且仍不超过理论最优解（按候选原本的方案等级）时返回true
+ */
+bool SUDSimulator::PlannedMoveValid(int disk, const PlannedMove &move) const {
+    if (move.stripe == -1) return false;
+    //前面的迁移改变了disk的瓶颈节点时，候选是针对旧瓶颈选出的
+    if (row_max.ArgMax(disk) != move.bottleneck) return false;
+    //瓶颈节点是原节点时，可能已在本轮前面迁走了它在该条带中的块，这次迁移不再降低G[disk][bottleneck]
+    if (!block_location.Contains(move.stripe, move.bottleneck)) return false;
+    //同一轮中其他节点可能已经把该条带的块迁移到了同一个目标节点
+    if (block_location.Contains(move.stripe, move.target)) return false;
+    if (move.plan == PLAN_C) return true;
+    if (disks[move.target].size() >= quota[move.target]) return false;
+    if (move.plan == PLAN_B) return true;
+    const int *members = block_location.Members(move.stripe);
+    if (disk_profile != nullptr ? ExceedsLimit(move.target, members, disk)
+                                : G.AnyAtLeast(move.target, members, cfg.n, disk, optimal))
+        return false;
+    //规划时超过了主机或机架上限的候选不必再检查拓扑，规划时满足的候选需要确认仍然满足
+    if (move.plan == PLAN_TOPOLOGY) return true;
+    return !level_graph.Active() || !level_graph.Exceeds(disk, move.target, members, cfg.n);
+}
+
+/**
+ * @brief   扩容函数
+ */
+void SUDSimulator::SUDExpand() {
+    PhaseTimer timer(stats.expand_ms);
+    //计算每个节点需要迁移几个块，节点相同时每个节点都相同。
+    //布局文件中的原节点可能不均衡，按实际块数计算，低于配额的原节点也作为目标节点补足
+    ComputeQuota(cfg.disk_num_origin, init_quota);
+    travel.resize(cfg.disk_num_origin);
+    expand_targets.clear();
+    for (int j = cfg.disk_num_origin; j < cfg.disk_num_after_scale; j++) {
+        expand_targets.push_back(j);
+    }
+    int travel_num = 0;
+    for (int i = 0; i < cfg.disk_num_origin; i++) {
+        int load = cfg.external_layout ? (int)disks[i].size() : init_quota[i];
+        travel[i] = max(load - quota[i], 0);
+        travel_num = max(travel_num, travel[i]);
+        if (cfg.external_layout && disks[i].size() < quota[i])
+            expand_targets.push_back(i);
+    }
+    assert(travel_num > 0);
+    //进行travel_num轮迁移，每轮每个还需要迁出的节点迁移一个块
+    int bottleneck_disk = 0;
+    //在disks中增加新节点
+    disks.Grow(cfg.disk_num_after_scale);
+    block_location.GrowDisks(cfg.disk_num_after_scale);
+    G.Grow(cfg.disk_num_after_scale);
+    //每轮每个原节点都要找一次瓶颈节点，用最大堆增量维护原节点所在行的最大值
+    row_max.Build(G, cfg.disk_num_origin, cfg.disk_num_after_scale, BottleneckWeights());
+    if (!pair_index.Active())
+        pair_index.Build(block_location);
+    //并行规划时每轮先对所有原节点同时选出候选迁移，再按节点号顺序合并，候选失效的节点按串行方式重新选择
+    bool parallel = cfg.plan_threads > 1;
+    if (parallel && (plan_pool == nullptr || plan_pool->Size() != cfg.plan_threads))
+        plan_pool.reset(new ThreadPool(cfg.plan_threads));
+    for (int round = 0; round < travel_num; round++) {
+        if (parallel)
+            PlanRound(round);
+        for (int i = 0; i < cfg.disk_num_origin; i++) {
+            if (round >= travel[i]) continue;
+            pair<int, int> travel_pair;
+            int plan;
+            if (parallel && PlannedMoveValid(i, round_plan[i])) {
+                travel_pair = make_pair(round_plan[i].stripe, round_plan[i].target);
+                plan = round_plan[i].plan;
+            } else {
+                if (parallel)
+                    SUD_STAT_ADD(stats, plan_replans, 1);
+                bottleneck_disk = row_max.ArgMax(i);
+                travel_pair = SelectTravelBlock(i, bottleneck_disk, &plan);
+            }
+            if (travel_pair.first == -1) {
+                cout << "fatal error" << endl;
+                fatal = 1;
+                row_max.Clear();
+                if (!keep_index)
+                    pair_index.Clear();
+                return;
+            }
+            moved_blocks++;
+            if (plan != PLAN_OPTIMAL)
+                suboptimal_moves++;
+            //方案等级按实际执行的迁移统计，并行规划中被丢弃的候选不计入
+            if (plan == PLAN_TOPOLOGY)
+                SUD_STAT_ADD(stats, select_plan_topology, 1);
+            else if (plan == PLAN_B)
+                SUD_STAT_ADD(stats, select_plan_b, 1);
+            else if (plan == PLAN_C)
+                SUD_STAT_ADD(stats, select_plan_c, 1);
+            if (cfg.evaluation == 0 && cfg.verbose == VERBOSE_FULL) {
+                if (plan != PLAN_OPTIMAL)
+                    cout << "采用次优解：";
+                cout << "将" << i << "节点的" << travel_pair.first << "块迁移至" << travel_pair.second << "节点" << '\n';
+            }
+            RecordMove(PHASE_EXPAND, travel_pair.first, i, travel_pair.second);
+            MoveBlock(travel_pair.first, i, travel_pair.second);
+        }
+    }
+    row_max.Clear();
+    if (!keep_index)
+        pair_index.Clear();
+    if (cfg.external_layout) {
+        //布局文件不均衡时迁出与迁入的块数都按实际块数计算，扩容后每个节点都应在配额之内
+        for (int i = 0; i < cfg.disk_num_after_scale; i++) {
+            if (disks[i].size() > quota[i])
+                cerr << "Warning: 扩容后节点" << i << "的块数" << disks[i].size() << "超过配额" << quota[i] << endl;
+        }
+    }
+    //检查是否达到理想最优解
+    if (cfg.evaluation == 0 && cfg.verbose > VERBOSE_QUIET)
+        cout << "理想最优解为" << optimal << endl;
+    ReportScaleResult("SUD扩展后的邻接矩阵：");
+}
+
+/**
+ * @brief   缩容过程中，寻找应该将指定块迁移到哪个容器中
+ * @param   block_no    要被迁移的块号
+ * @param   src_disk    块当前所在的节点，检查边数时跳过
+ * @param   plan    若不为空，返回所采用方案的等级：PLAN_OPTIMAL、PLAN_TOPOLOGY、PLAN_B或PLAN_C
+ */
+int SUDSimulator::FindTargetDisk(int block_no, int src_disk, int *plan){
+    return (this->*find_impl)(block_no, src_disk, plan);
+}
+
+template <int N>
+int SUDSimulator::FindTargetDiskImpl(int block_no, int src_disk, int *plan){
+    int plan_b = -1;
+    int plan_b_level = PLAN_C;
+    int plan_topology = -1;     //不超过节点对的理论最优解但超过主机或机架上限的目标节点中超出最少的
+    double topology_load = 0;
+    SUD_STAT_ADD(stats, find_calls, 1);
+    for (int i = 0; i < cfg.disk_num_after_scale; i++) {
+        if (block_location.Contains(block_no, i)) {
+            //当前节点中已经有了和block_no在同一个条带的块
+            continue;
+        } else {
+            //当前节点中没有和block_no在同一个条带的块
+            if (disks[i].size() + 1 > quota[i]) {
+                //当前节点已经没有位置
+                plan_b = i;
+                plan_b_level = PLAN_C;
+                continue;
+            } else {
+                //当前节点还有位置
+                plan_b = i;
+                plan_b_level = PLAN_B;
+                //判断如果转移到这个节点，是否会破坏理论最优解
+                if (!ExceedsOptimal<N>(i, block_location.Members(block_no), src_disk)) {
+                    if (level_graph.Active()) {
+                        double load = level_graph.Load(src_disk, i, block_location.Members(block_no), cfg.n);
+                        if (load > 1) {
+                            if (plan_topology == -1 || load < topology_load) {
+                                plan_topology = i;
+                                topology_load = load;
+                            }
+                            continue;
+                        }
+                    }
+                    //找到了合适的目标节点
+                    SUD_STAT_ADD(stats, find_probes, i + 1);
+                    if (plan != nullptr) *plan = PLAN_OPTIMAL;
+                    return i;
+                }
+            }
+        }
+    }
+    SUD_STAT_ADD(stats, find_probes, cfg.disk_num_after_scale);
+    if (plan_topology != -1) {
+        SUD_STAT_ADD(stats, find_plan_topology, 1);
+        if (plan != nullptr) *plan = PLAN_TOPOLOGY;
+        return plan_topology;
+    }
+    if (plan_b_level == PLAN_B)
+        SUD_STAT_ADD(stats, find_plan_b, 1);
+    else
+        SUD_STAT_ADD(stats, find_plan_c, 1);
+    if (plan != nullptr) *plan = plan_b_level;
+    return plan_b;
+}
+
+/**
+ * @brief   缩容函数
+ */
+void SUDSimulator::SUDShrink(){
+    PhaseTimer timer(stats.shrink_ms);
+    for (int i = cfg.disk_num_after_scale; i < cfg.disk_num_origin; i++) {
+        if (cfg.shrink == SHRINK_FLOW) {
+            ShrinkByFlow(i);
+            if (fatal == 1) return;
+            continue;
+        }
+        while (!disks[i].empty()) {
+            //从末尾取块，删除时不需要移动其他块
+            int block_temp = disks[i].back();
+            int plan;
+            int target_disk = FindTargetDisk(block_temp, i, &plan);
+            if (target_disk == -1) {
+                cout << "fatal error" << endl;
+                fatal = 1;
+                return;
+            }
+            ShrinkMove(block_temp, i, target_disk, plan);
+        }
+    }
+    //检查是否达到理想最优解
+    if (cfg.evaluation == 0 && cfg.verbose > VERBOSE_QUIET)
+        cout << "理想最优解为" << optimal << endl;
+    if (cfg.evaluation == 0 && cfg.verbose == VERBOSE_FULL) {
+        cout << "缩容后各节点中的块数：" << '\n';
+        for (int i = 0; i < cfg.disk_num_origin; i++) {
+            cout << disks[i].size() << " ";
+        }
+        cout << '\n';
+    }
+    ReportScaleResult("缩容后的邻接矩阵：");
+}
+
+/**
+ * @brief   缩容时把条带stripe位于src的块迁移到target，并统计、输出与记录这次迁移
+ */
+void SUDSimulator::ShrinkMove(int stripe, int src, int target, int plan) {
+    moved_blocks++;
+    if (plan != PLAN_OPTIMAL)
+        suboptimal_moves++;
+    if (cfg.evaluation == 0 && cfg.verbose == VERBOSE_FULL) {
+        if (plan != PLAN_OPTIMAL)
+            cout << "采用次优解：";
+        cout << "将" << src << "节点的" << stripe << "块迁移至" << target << "节点" << '\n';
+    }
+    RecordMove(PHASE_SHRINK, stripe, src, target);
+    MoveBlock(stripe, src, target);
+}
+
+/**
+ * @brief   把条带stripe位于src的块迁移到target的费用，按字典序依次比较：迁移后target与条带中其他节点之间
+            超过理论最优解最多的边数、是否超过主机或机架上限、target与条带中其他节点之间的最大边数。
+            位于将被移除的节点上的块之间的边在缩容结束后都会消失，不计入费用
+ * @param   plan    返回这次迁移对应的方案等级：PLAN_OPTIMAL、PLAN_TOPOLOGY或PLAN_B
+ */
+long long SUDSimulator::ShrinkCost(int stripe, int src, int target, int *plan) const {
+    const int *members = block_location.Members(stripe);
+    long long worst = 0;
+    long long excess = 0;
+    for (int m = 0; m < cfg.n; m++) {
+        int x = members[m];
+        if (x == src || x >= cfg.disk_num_after_scale) continue;
+        long long e = (long long)G.Get(target, x) + 1;
+        long long limit = disk_profile != nullptr ? min(edge_limit[target], edge_limit[x]) : optimal;
+        excess = max(excess, e - limit);
+        worst = max(worst, e);
+    }
+    int topology_exceeded = level_graph.Active() && level_graph.Exceeds(src, target, members, cfg.n);
+    *plan = excess > 0 ? PLAN_B : (topology_exceeded ? PLAN_TOPOLOGY : PLAN_OPTIMAL);
+    //worst不超过条带数，excess不超过worst，三项分别放在互不重叠的区间中
+    long long scale = (long long)cfg.stripe_num + 2;
+    return (excess * 2 + topology_exceeded) * scale + worst;
+}
+
+/**
+ * @brief   按批分配被移除节点disk上的块：每批取至多cfg.shrink_batch个块，与仍有空位的目标节点构成二部图，
+            每个目标节点在一批中至多接收一个块，求费用之和最小的指派（容量为1的最小费用流），费用见ShrinkCost。
+            同一批的费用都按这一批开始时的邻接矩阵计算；没有指派到目标节点的块按FindTargetDisk逐个处理
+ */
+void SUDSimulator::ShrinkByFlow(int disk) {
+    while (!disks[disk].empty()) {
+        flow_targets.clear();
+        for (int t = 0; t < cfg.disk_num_after_scale; t++) {
+            if (disks[t].size() < quota[t]) flow_targets.push_back(t);
+        }
+        int batch = min(min(cfg.shrink_batch, disks[disk].size()), (int)flow_targets.size());
+        if (batch == 0) {
+            //所有目标节点都已满时不经过指派，直接取一个块由FindTargetDisk处理
+            flow_blocks.assign(disks[disk].end() - 1, disks[disk].end());
+            flow_assign.assign(1, -1);
+            batch = 1;
+        } else {
+            flow_blocks.assign(disks[disk].end() - batch, disks[disk].end());
+            SUD_STAT_ADD(stats, flow_batches, 1);
+            shrink_assign.Reset(batch, flow_targets.size());
+            for (int b = 0; b < batch; b++) {
+                for (int j = 0; j < flow_targets.size(); j++) {
+                    if (block_location.Contains(flow_blocks[b], flow_targets[j])) continue;
+                    int plan;
+                    shrink_assign.SetCost(b, j, ShrinkCost(flow_blocks[b], disk, flow_targets[j], &plan));
+                }
+            }
+            shrink_assign.Solve(flow_assign);
+        }
+        for (int b = 0; b < batch; b++) {
+            int stripe = flow_blocks[b];
+            int plan;
+            int target;
+            if (flow_assign[b] == -1) {
+                SUD_STAT_ADD(stats, flow_fallbacks, 1);
+                target = FindTargetDisk(stripe, disk, &plan);
+                if (target == -1) {
+                    cout << "fatal error" << endl;
+                    fatal = 1;
+                    return;
+                }
+            } else {
+                target = flow_targets[flow_assign[b]];
+                //同一批中前面的迁移可能改变了邻接矩阵，按实际迁移时的状态确定方案等级
+                ShrinkCost(stripe, disk, target, &plan);
+            }
+            ShrinkMove(stripe, disk, target, plan);
+        }
+    }
+}
+
+/**
+ * @brief   数据重新分布函数
+ */
+void SUDSimulator::Redistribute(){
+    PhaseTimer timer(stats.redistribute_ms);
+    if (cfg.redistribute == REDIST_SWAP) {
+        SwapRedistribute();
+        return;
+    }
+    cfg.disk_num_after_scale = cfg.VirtualDiskNum();
+    if (cfg.verbose > VERBOSE_QUIET)
+        cout << "虚拟扩容节点数为" << cfg.disk_num_after_scale << endl;
+    UpdateBounds();
+    SUDExpand();
+    if (fatal == 1) return;
+    int temp = cfg.disk_num_after_scale;
+    cfg.disk_num_after_scale = cfg.disk_num_origin;
+    cfg.disk_num_origin = temp;
+    UpdateBounds();
+    SUDShrink();
+}
+
+/**
+ * @brief   直接重分布：反复选取边数等于当前最大值top的节点对(a, b)，把a与b共享的一个条带在a上的块
+            迁移到节点c，同时把c上的一个块迁移到a。交换后各节点的块数不变，(a, b)的边数减1，
+            其余被增加的边都不超过top-1，因此边数为top的节点对严格减少。达到理想最优解或所有最大边都
+            无法再交换时结束。与虚拟扩容后缩容相比，块只在现有节点之间移动一次
+ */
+void SUDSimulator::SwapRedistribute() {
+    int disk_num = cfg.disk_num_origin;
+    UpdateBounds();
+    row_max.Build(G, disk_num, disk_num);
+    pair_index.Build(block_location);
+    long long swaps = 0;
+    while (true) {
+        edge_t top = 0;
+        for (int a = 0; a < disk_num; a++) {
+            top = max(top, row_max.Max(a));
+        }
+        if (top <= optimal) break;
+        int improved = 0;
+        for (int a = 0; a < disk_num; a++) {
+            if (row_max.Max(a) != top) continue;
+            //a所在行可能有多条最大边，依次尝试直到有一条交换成功
+            for (int b = 0; b < disk_num; b++) {
+                if (G.Get(a, b) != top) continue;
+                if (TrySwap(a, b, top)) {
+                    improved = 1;
+                    swaps++;
+                    break;
+                }
+            }
+        }
+        if (!improved) break;
+    }
+    row_max.Clear();
+    pair_index.Clear();
+    if (cfg.evaluation == 0 && cfg.verbose > VERBOSE_QUIET) {
+        cout << "直接重分布共交换" << swaps << "次" << endl;
+        cout << "理想最优解为" << optimal << endl;
+    }
+    ReportScaleResult("直接重分布后的邻接矩阵：");
+}
+
+/**
+ * @brief   为边数为top的节点对(a, b)寻找一次交换，找到时立即执行
+ * @return  执行了交换返回true
+ */
+bool SUDSimulator::TrySwap(int a, int b, int top) {
+    SUD_STAT_ADD(stats, swap_calls, 1);
+    int disk_num = cfg.disk_num_origin;
+    //swap_back[c]为c上第一个不依赖s就能换回a的块：-2表示尚未查找，-1表示不存在
+    swap_back.assign(disk_num, -2);
+    BlockList candidates = pair_index.Stripes(a, b);
+    for (int i = 0; i < candidates.size(); i++) {
+        int s = candidates[i];
+        const int *members_s = block_location.Members(s);
+        //s迁出后a与s中边数为top-1的节点之间降为top-2，只有包含这些节点的块才需要针对s单独检查
+        int relaxed = 0;
+        for (int m = 0; m < cfg.n; m++) {
+            if (members_s[m] != a && G.Get(a, members_s[m]) == top - 1) relaxed = 1;
+        }
+        for (int c = 0; c < disk_num; c++) {
+            if (c == a || block_location.Contains(s, c)) continue;
+            //s的块迁移到c后，c与s中其他节点之间的边数都要不超过top-1
+            if (G.AnyAtLeast(c, members_s, cfg.n, a, top - 1)) continue;
+            if (swap_back[c] == -2) {
+                swap_back[c] = -1;
+                BlockList on_c = disks[c];
+                for (int j = 0; j < on_c.size(); j++) {
+                    if (SwapBackValid(on_c[j], a, c, -1, top)) {
+                        swap_back[c] = on_c[j];
+                        break;
+                    }
+                }
+            }
+            int t = swap_back[c];
+            if (t == -1 && relaxed) {
+                //只在c与s中边数为top-1的节点共享的条带里找
+                for (int m = 0; m < cfg.n && t == -1; m++) {
+                    int y = members_s[m];
+                    if (y == a || G.Get(a, y) != top - 1) continue;
+                    BlockList shared = pair_index.Stripes(c, y);
+                    for (int j = 0; j < shared.size(); j++) {
+                        if (SwapBackValid(shared[j], a, c, s, top)) {
+                            t = shared[j];
+                            break;
+                        }
+                    }
+                }
+            }
+            if (t >= 0) {
+                if (cfg.evaluation == 0 && cfg.verbose == VERBOSE_FULL) {
+                    cout << "交换：将" << a << "节点的" << s << "块迁移至" << c << "节点，将" << c << "节点的" << t
+                         << "块迁移至" << a << "节点" << '\n';
+                }
+                RecordMove(PHASE_REBALANCE, s, a, c);
+                MoveBlock(s, a, c);
+                RecordMove(PHASE_REBALANCE, t, c, a);
+                MoveBlock(t, c, a);
+                moved_blocks += 2;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief   检查把条带t位于c的块换回a后，a与t中其他节点之间的边数是否都不超过top-1
+ * @param   s   同时从a迁出的条带，a与其中节点之间的边数按减1计算；为-1时不考虑
+ */
+bool SUDSimulator::SwapBackValid(int t, int a, int c, int s, int top) const {
+    SUD_STAT_ADD(stats, swap_probes, 1);
+    if (block_location.Contains(t, a)) return false;
+    const int *members_t = block_location.Members(t);
+    for (int m = 0; m < cfg.n; m++) {
+        int y = members_t[m];
+        if (y == c) continue;
+        long long after = (long long)G.Get(a, y) + 1;
+        if (s >= 0 && block_location.Contains(s, y)) after--;
+        if (after > top - 1) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief   计算前disk_num_after_scale个节点的平均传输开销，即邻接矩阵各行最大值的平均值
+ */
+double SUDSimulator::AverageTransferCost() const {
+    double cost = 0;
+    for (int i = 0; i < cfg.disk_num_after_scale; i++) {
+        int arg;
+        cost += (double)G.RowArgMax(i, cfg.disk_num_after_scale, arg);
+    }
+    return cost / cfg.disk_num_after_scale;
+}
+
+/**
+ * @brief   评估函数。先在原节点上随机生成数据并执行SUD扩缩容，再直接在扩缩容后的节点上随机生成数据，
+            对比两者的平均传输开销，结果保存在sud_cost与random_cost中
+ */
+void SUDSimulator::Evaluation(){
+    if (cfg.disk_num_origin == cfg.disk_num_after_scale) return;
+    int is_expand = cfg.disk_num_origin < cfg.disk_num_after_scale;
+    InitDisks();
+    if (cfg.verbose == VERBOSE_FULL)
+        cout << "根据随机数据生成的邻接矩阵：" << endl;
+    InitGraph();
+    if (is_expand) {
+        SUDExpand();
+    } else {
+        SUDShrink();
+    }
+    sud_cost = AverageTransferCost();
+    if (cfg.verbose > VERBOSE_QUIET)
+        cout << "平均传输开销：" << sud_cost << endl << endl;
+    int temp = cfg.disk_num_origin;
+    cfg.disk_num_origin = cfg.disk_num_after_scale;
+    InitDisks();
+    if (cfg.verbose == VERBOSE_FULL)
+        cout << (is_expand ? "随机扩展后生成的邻接矩阵：" : "随机缩容后生成的邻接矩阵：") << endl;
+    InitGraph();
+    random_cost = AverageTransferCost();
+    if (cfg.verbose > VERBOSE_QUIET)
+        cout << "平均传输开销：" << random_cost << endl << endl;
+    cfg.disk_num_origin = temp;
+}
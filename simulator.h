@@ -0,0 +1,222 @@
+/*********************************************************************************
+  * FileName:  simulator.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  SUD扩缩容模拟器，持有一次模拟的全部状态，可在多次运行之间复用
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_SIMULATOR_H
+#define SUD_SCALE_SIMULATION_SIMULATOR_H
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include "config.h"
+#include "graph.h"
+#include "layout.h"
+#include "layoutfile.h"
+#include "diskprofile.h"
+#include "topology.h"
+#include "rowmax.h"
+#include "pairindex.h"
+#include "parallel.h"
+#include "planwriter.h"
+#include "recovery.h"
+#include "stats.h"
+#include "rng.h"
+#include "assignment.h"
+using namespace std;
+
+/*一次模拟的结果*/
+struct SimResult {
+    int optimal = 0;            //理想最优解
+    int max_edge = 0;           //扩缩容后邻接矩阵中的最大值
+    int is_optimal = 0;         //是否得到理想最优解
+    long long moved_blocks = 0; //迁移的块数
+    int fatal = 0;              //是否出现无法迁移的块
+    double sud_cost = 0;        //评估模式：SUD扩缩容后的平均传输开销
+    double random_cost = 0;     //评估模式：直接在扩缩容后的节点上随机放置时的平均传输开销
+    double optimal_time = 0;    //设置了节点配置时：理想的恢复时间
+    double max_time = 0;        //设置了节点配置时：扩缩容后各节点对的最大恢复时间，见DiskProfile
+    int topology_optimal = 1;   //设置了拓扑时：各层每对主机、机架之间的边数是否都不超过上限
+    long long level_edge[LEVEL_NUM] = {0};  //设置了拓扑时：各层中边数与上限之比最大的一对主机或机架的边数
+    long long level_limit[LEVEL_NUM] = {0}; //以及这一对的上限
+    RecoveryResult recovery_before;     //扩缩容前的单节点故障恢复读负载，cfg.recovery为1时有效
+    RecoveryResult recovery_after;      //扩缩容后的单节点故障恢复读负载
+};
+
+/*时间线模式中一步扩缩容的结果*/
+struct TimelineStep {
+    int disk_num_before = 0;
+    int disk_num_after = 0;
+    int optimal = 0;            //这一步扩缩容后的理想最优解
+    int max_edge = 0;           //这一步扩缩容后邻接矩阵中的最大值
+    int is_optimal = 0;
+    long long moved_blocks = 0;         //这一步迁移的块数
+    long long suboptimal_moves = 0;     //这一步采用次优解的迁移数
+    long long total_moved_blocks = 0;   //截至这一步累计迁移的块数
+    double elapsed_ms = 0;
+};
+
+bool cmp(pair<int, int> p1, pair<int, int> p2);
+
+/*SelectTravelBlock所采用方案的等级*/
+enum TravelPlan {
+    PLAN_OPTIMAL,   //目标节点有空位且迁移后不超过理论最优解
+    PLAN_TOPOLOGY,  //目标节点有空位且不超过节点对的理论最优解，但会超过某对主机或机架之间的上限
+    PLAN_B,         //目标节点有空位，但迁移后会超过理论最优解
+    PLAN_C          //目标节点已满
+};
+
+/*并行规划时一个原节点在本轮中的候选迁移*/
+struct PlannedMove {
+    int bottleneck = -1;    //规划时disk的瓶颈节点
+    int stripe = -1;
+    int target = -1;
+    int plan = PLAN_OPTIMAL;
+};
+
+class SUDSimulator {
+public:
+    SUDSimulator();
+    ~SUDSimulator();
+    SUDSimulator(const SUDSimulator &) = delete;
+    SUDSimulator &operator=(const SUDSimulator &) = delete;
+
+    /**
+     * @brief   载入新的配置并清空上一次运行的状态，已分配的内存会被保留下来复用
+     */
+    void Reset(const SimConfig &config);
+    /**
+     * @brief   按照配置执行一次完整的模拟：扩容、缩容、重分布或评估
+     */
+    SimResult Run();
+    /**
+     * @brief   时间线模式：生成初始布局后按cfg.timeline在同一布局上依次扩缩容，每一步直接沿用上一步的
+                邻接矩阵、节点块列表与节点对索引，不重新初始化
+     * @param   steps   返回每一步的结果
+     * @return  最后一步之后的结果，moved_blocks为累计迁移的块数
+     */
+    SimResult RunTimeline(vector<TimelineStep> &steps);
+
+    const DiskBlockSet &GetDisks() const;
+    const AdjacencyMatrix &GetGraph() const;
+    int Fatal() const { return fatal; }
+    /**
+     * @brief   最近一次Reset之后的计数器与阶段耗时
+     */
+    const SimStats &Stats() const { return stats; }
+    /**
+     * @brief   设置迁移计划的输出，为空时不记录。writer由调用者持有
+     */
+    void SetPlanWriter(PlanWriter *writer);
+    /**
+     * @brief   设置保存迁移计划的数组，为空时不保存。record由调用者持有，Reset不会清空它
+     */
+    void SetPlanRecord(vector<MoveRecord> *record);
+    /**
+     * @brief   设置初始布局文件，不为空时InitDisks从文件载入布局而不是随机放置。layout由调用者持有，
+                其条带数、条带长度与节点数需与配置一致
+     */
+    void SetLayout(LayoutFile *layout);
+    /**
+     * @brief   设置各节点的容量与带宽权重，为空时所有节点相同。profile由调用者持有，需在Reset之后调用
+     */
+    void SetDiskProfile(const DiskProfile *profile);
+    /**
+     * @brief   设置节点所在的主机与机架，不为空时维护按主机、机架聚合的邻接矩阵，扩缩容优先选择不超过各层上限的迁移。
+                topology由调用者持有，需覆盖运行中出现的所有节点，需在Reset之后、Run之前调用
+     */
+    void SetTopology(const Topology *topology);
+
+    void InitDisks();
+    void InitGraph();
+    void SUDExpand();
+    void SUDShrink();
+    void ShrinkByFlow(int disk);
+    pair<int, int> SelectTravelBlock(int disk, int bottleneck_disk, int *plan = nullptr) const;
+    int FindTargetDisk(int block_no, int src_disk, int *plan = nullptr);
+    void Redistribute();
+    void SwapRedistribute();
+    void Evaluation();
+
+private:
+    void PlaceBlock(int stripe, int slot, int disk);
+    void MoveBlock(int stripe, int from, int to);
+    void AddEdge(int a, int b, int delta);
+    void PlaceBySort(int cur_stripe_num);
+    void PlaceByHeap(int cur_stripe_num);
+    void ClearLayout();
+    void UpdateBounds();
+    void ComputeQuota(int disk_num, vector<int> &quota) const;
+    bool ExceedsLimit(int disk, const int *members, int skip) const;
+    void LoadLayout();
+    void PrintGraph(int disk_num) const;
+    void ReportScaleResult(const char *title) const;
+    void RecordMove(int phase, int stripe, int from, int to);
+    void AnalyzeFailures(int disk_num, RecoveryResult &res) const;
+    void PlanRound(int round);
+    const vector<double> *BottleneckWeights();
+    void BindWidthImpl();
+    template <int N> void BindWidth();
+    template <int N> void InitGraphImpl();
+    template <int N> pair<int, int> SelectTravelBlockImpl(int disk, int bottleneck_disk, int *plan) const;
+    template <int N> pair<int, int> SelectSpareTarget(int disk) const;
+    template <int N> int FindTargetDiskImpl(int block_no, int src_disk, int *plan);
+    template <int N> bool ExceedsOptimal(int disk, const int *members, int skip) const;
+    bool PlannedMoveValid(int disk, const PlannedMove &move) const;
+    void ShrinkMove(int stripe, int src, int target, int plan);
+    long long ShrinkCost(int stripe, int src, int target, int *plan) const;
+    bool TrySwap(int a, int b, int top);
+    bool SwapBackValid(int t, int a, int c, int s, int top) const;
+    void CollectResult(SimResult &res, int disk_num) const;
+    double AverageTransferCost() const;
+
+    SimConfig cfg;
+    int optimal;                //理想最优解，重分布时会随虚拟节点数变化。设置了节点配置时为各节点边数上限的最大值
+    const DiskProfile *disk_profile;    //各节点的容量与带宽权重，为空时所有节点相同
+    const Topology *topology;   //节点所在的主机与机架，为空时不考虑拓扑
+    LevelGraph level_graph;     //按主机、机架聚合的邻接矩阵与各层上限，设置了拓扑时与G同步维护
+    vector<int> quota;          //扩缩容后前disk_num_after_scale个节点各自应存放的块数
+    vector<int> init_quota;     //InitDisks与SUDExpand中扩缩容前各节点应存放的块数
+    vector<int> edge_limit;     //设置了节点配置时各节点的边数上限，节点对的上限取两端的较小值
+    vector<int> travel;         //扩容时每个原节点需要迁出的块数
+    vector<int> expand_targets; //扩容时的目标节点：新节点，以及布局文件中块数低于配额的原节点
+    vector<double> bottleneck_bw;   //设置了节点配置时交给row_max的各节点带宽
+    double optimal_time;        //设置了节点配置时的理想恢复时间
+    DiskBlockSet disks;         //用于表示每个节点中存储块的情况
+    StripeTable block_location; //每个条带的块所在的节点
+    vector<int> shuffle_buf;    //InitDisks中用于随机选择节点的节点号数组
+    vector<pair<int, int> > placement_heap; //PlaceByHeap使用的<块数, 节点号>最小堆
+    AdjacencyMatrix G;          //表示两个节点之间的边数
+    RowMaxTracker row_max;      //扩容过程中原节点所在行的最大值
+    PairStripeIndex pair_index; //扩容过程中每对节点共享的条带
+    int keep_index;             //时间线模式中pair_index在各步之间持续维护，扩容结束后不清除
+    unique_ptr<ThreadPool> plan_pool;   //并行规划使用的线程池，线程数变化时才重新创建
+    vector<PlannedMove> round_plan;     //并行规划时本轮每个原节点的候选迁移
+    vector<int> swap_back;      //直接重分布中每个节点上可以换回的块，见TrySwap
+    AssignmentSolver shrink_assign;     //按批缩容时一批块到目标节点的指派，见ShrinkByFlow
+    vector<int> flow_targets;   //按批缩容时这一批可选的目标节点
+    vector<int> flow_blocks;    //按批缩容时这一批的块
+    vector<int> flow_assign;    //每个块指派到的目标节点在flow_targets中的下标，-1表示未指派
+    PlanWriter *plan_writer;    //迁移计划的输出，为空时不记录
+    vector<MoveRecord> *plan_record;    //保存在内存中的迁移计划，为空时不保存
+    LayoutFile *layout_file;    //初始布局文件，为空时随机生成初始布局
+    long long moved_blocks;
+    long long suboptimal_moves; //采用次优解的迁移数
+    int fatal;
+    double sud_cost;
+    double random_cost;
+    /*
+     * 按条带长度选出的InitGraph、SelectTravelBlock与FindTargetDisk实现。常用的条带长度（见BindWidthImpl）
+     * 各有一份以条带长度为模板参数的实例，条带内的循环在编译期展开；其他条带长度使用N为0的通用实例
+     */
+    void (SUDSimulator::*init_graph_impl)();
+    pair<int, int> (SUDSimulator::*select_impl)(int, int, int *) const;
+    int (SUDSimulator::*find_impl)(int, int, int *);
+    mutable SimStats stats;     //SelectTravelBlock是const且可能在多个线程中执行，计数器需要在其中累加
+    CounterRng rng;             //每个模拟器独立的随机数发生器，由cfg.seed初始化
+};
+
+#endif //SUD_SCALE_SIMULATION_SIMULATOR_H
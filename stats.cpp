@@ -0,0 +1,67 @@
+/*********************************************************************************
+  * FileName:  stats.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  热点路径计数器与阶段计时，每次运行输出一份JSON报告
+**********************************************************************************/
+
+#include "stats.h"
+#include "simulator.h"
+
+using namespace std;
+
+void SimStats::Reset() {
+    select_calls = 0;
+    select_scanned = 0;
+    select_plan_topology = 0;
+    select_plan_b = 0;
+    select_plan_c = 0;
+    plan_replans = 0;
+    find_calls = 0;
+    find_probes = 0;
+    find_plan_topology = 0;
+    find_plan_b = 0;
+    find_plan_c = 0;
+    flow_batches = 0;
+    flow_fallbacks = 0;
+    swap_calls = 0;
+    swap_probes = 0;
+    g_updates = 0;
+    init_disks_ms = 0;
+    init_graph_ms = 0;
+    expand_ms = 0;
+    shrink_ms = 0;
+    redistribute_ms = 0;
+    recovery_ms = 0;
+    total_ms = 0;
+}
+
+void SimStats::WriteJson(ostream &out, const SimConfig &cfg, const SimResult &res) const {
+    out << "{\"config\": {\"origin\": " << cfg.disk_num_origin << ", \"target\": " << cfg.disk_num_after_scale
+        << ", \"stripes\": " << cfg.stripe_num << ", \"n\": " << cfg.n << ", \"k\": " << cfg.k
+        << ", \"seed\": " << cfg.seed << ", \"plan_threads\": " << cfg.plan_threads << "}";
+    out << ", \"result\": {\"optimal\": " << res.optimal << ", \"max_edge\": " << res.max_edge
+        << ", \"is_optimal\": " << res.is_optimal << ", \"moved_blocks\": " << res.moved_blocks
+        << ", \"fatal\": " << res.fatal << "}";
+    out << ", \"counters_enabled\": " << (g_StatsEnabled ? "true" : "false");
+    if (g_StatsEnabled) {
+        long long calls = select_calls;
+        long long probes_calls = find_calls;
+        out << ", \"counters\": {\"select_calls\": " << calls << ", \"select_scanned\": " << select_scanned
+            << ", \"select_scanned_per_call\": " << (calls > 0 ? (double)select_scanned / calls : 0)
+            << ", \"select_plan_topology\": " << select_plan_topology
+            << ", \"select_plan_b\": " << select_plan_b << ", \"select_plan_c\": " << select_plan_c
+            << ", \"plan_replans\": " << plan_replans << ", \"find_calls\": " << probes_calls
+            << ", \"find_probes\": " << find_probes
+            << ", \"find_probes_per_call\": " << (probes_calls > 0 ? (double)find_probes / probes_calls : 0)
+            << ", \"find_plan_topology\": " << find_plan_topology
+            << ", \"find_plan_b\": " << find_plan_b << ", \"find_plan_c\": " << find_plan_c
+            << ", \"flow_batches\": " << flow_batches << ", \"flow_fallbacks\": " << flow_fallbacks
+            << ", \"swap_calls\": " << swap_calls << ", \"swap_probes\": " << swap_probes
+            << ", \"g_updates\": " << g_updates << "}";
+    }
+    out << ", \"timers_ms\": {\"init_disks\": " << init_disks_ms << ", \"init_graph\": " << init_graph_ms
+        << ", \"expand\": " << expand_ms << ", \"shrink\": " << shrink_ms
+        << ", \"redistribute\": " << redistribute_ms << ", \"recovery\": " << recovery_ms
+        << ", \"total\": " << total_ms << "}}";
+}
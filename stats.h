@@ -0,0 +1,80 @@
+/*********************************************************************************
+  * FileName:  stats.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  热点路径计数器与阶段计时，每次运行输出一份JSON报告
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_STATS_H
+#define SUD_SCALE_SIMULATION_STATS_H
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+using namespace std;
+
+/*
+ * 计数器只在定义了SUD_STATS（CMake选项SUD_STATS）时编译进来，否则SUD_STAT_ADD展开为空，
+ * 热点路径上没有任何额外开销。并行规划时SelectTravelBlock在多个线程中执行，计数器使用relaxed原子加。
+ * 阶段计时每个阶段只读两次时钟，始终开启
+ */
+#ifdef SUD_STATS
+#define SUD_STAT_ADD(stats, field, value) ((stats).field.fetch_add((value), memory_order_relaxed))
+const int g_StatsEnabled = 1;
+#else
+#define SUD_STAT_ADD(stats, field, value) ((void)0)
+const int g_StatsEnabled = 0;
+#endif
+
+struct SimConfig;
+struct SimResult;
+
+struct SimStats {
+    atomic<long long> select_calls;     //SelectTravelBlock调用次数，包括并行规划中之后被丢弃的候选
+    atomic<long long> select_scanned;   //SelectTravelBlock检查的候选块数
+    //以下三项按扩容实际执行的迁移统计
+    atomic<long long> select_plan_topology; //扩容满足节点对的理论最优解但超过主机或机架上限的次数
+    atomic<long long> select_plan_b;    //扩容采用次优解（目标节点有空位但超过理论最优解）的次数
+    atomic<long long> select_plan_c;    //扩容采用目标节点已满的方案的次数
+    atomic<long long> plan_replans;     //并行规划的候选在合并时失效、需要重新选择的次数
+    atomic<long long> find_calls;       //FindTargetDisk调用次数
+    atomic<long long> find_probes;      //FindTargetDisk检查的候选节点数
+    atomic<long long> find_plan_topology;   //缩容满足节点对的理论最优解但超过主机或机架上限的次数
+    atomic<long long> find_plan_b;      //缩容采用次优解的次数
+    atomic<long long> find_plan_c;      //缩容采用目标节点已满的方案的次数
+    atomic<long long> flow_batches;     //按批缩容求解指派问题的次数
+    atomic<long long> flow_fallbacks;   //按批缩容中未分配到目标节点、改用FindTargetDisk的块数
+    atomic<long long> swap_calls;       //直接重分布尝试降低一条最大边的次数
+    atomic<long long> swap_probes;      //直接重分布检查的换回块数
+    atomic<long long> g_updates;        //邻接矩阵的修改次数
+    //各阶段的累计耗时，毫秒
+    double init_disks_ms;
+    double init_graph_ms;
+    double expand_ms;
+    double shrink_ms;
+    double redistribute_ms;     //重分布的总耗时，虚拟扩容方式中同时计入expand与shrink
+    double recovery_ms;
+    double total_ms;
+
+    SimStats() { Reset(); }
+    void Reset();
+    /**
+     * @brief   以JSON对象的形式输出一次运行的配置、结果、计数器与阶段耗时，不换行
+     */
+    void WriteJson(ostream &out, const SimConfig &cfg, const SimResult &res) const;
+};
+
+/*构造时开始计时，析构时把经过的毫秒数累加到指定的变量*/
+class PhaseTimer {
+public:
+    explicit PhaseTimer(double &target) : target(target), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        target += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    double &target;
+    chrono::steady_clock::time_point start;
+};
+
+#endif //SUD_SCALE_SIMULATION_STATS_H
@@ -0,0 +1,169 @@
+/*********************************************************************************
+  * FileName:  topology.cpp
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  节点-主机-机架的拓扑，以及按主机、机架聚合的邻接矩阵与各层的理想最优解
+**********************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "topology.h"
+#include "config.h"
+
+using namespace std;
+
+int Topology::GroupId(int level, const string &name) {
+    for (int i = 0; i < names[level].size(); i++) {
+        if (names[level][i] == name) return i;
+    }
+    names[level].push_back(name);
+    return names[level].size() - 1;
+}
+
+int Topology::Load(const string &path, string &err) {
+    ifstream in(path);
+    if (!in) {
+        err = "无法打开拓扑文件 " + path;
+        return -1;
+    }
+    for (int l = 0; l < LEVEL_NUM; l++) {
+        group[l].clear();
+        names[l].clear();
+    }
+    vector<int> host_rack;      //每台主机所在的机架
+    string line;
+    int line_no = 0;
+    while (getline(in, line)) {
+        line_no++;
+        size_t pos = line.find('#');
+        if (pos != string::npos) line.erase(pos);
+        istringstream iss(line);
+        string range;
+        if (!(iss >> range)) continue;      //空行
+        int first, last;
+        char dash;
+        istringstream rs(range);
+        if (!(rs >> first)) first = -1;
+        last = first;
+        if (rs >> dash && (dash != '-' || !(rs >> last))) first = -1;
+        string host, rack;
+        if (first < 0 || last < first || last >= g_MaxDiskNum || !(iss >> host >> rack)) {
+            err = "拓扑文件第" + to_string(line_no) + "行格式错误，应为: first[-last] host rack";
+            return -1;
+        }
+        int h = GroupId(LEVEL_HOST, host);
+        int r = GroupId(LEVEL_RACK, rack);
+        if (h == host_rack.size()) host_rack.push_back(r);
+        if (host_rack[h] != r) {
+            err = "拓扑文件第" + to_string(line_no) + "行：主机" + host + "已属于机架" + names[LEVEL_RACK][host_rack[h]];
+            return -1;
+        }
+        if (group[LEVEL_HOST].size() <= last) {
+            group[LEVEL_HOST].resize(last + 1, -1);
+            group[LEVEL_RACK].resize(last + 1, -1);
+        }
+        for (int i = first; i <= last; i++) {
+            group[LEVEL_HOST][i] = h;
+            group[LEVEL_RACK][i] = r;
+        }
+    }
+    return 0;
+}
+
+int Topology::Covers(int disk_num, string &err) const {
+    for (int i = 0; i < disk_num; i++) {
+        if (i >= group[LEVEL_HOST].size() || group[LEVEL_HOST][i] < 0) {
+            err = "拓扑文件中没有指定节点" + to_string(i) + "所在的主机与机架";
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void LevelGraph::Reset(const Topology *topology) {
+    topo = topology;
+    if (topo == nullptr) return;
+    for (int l = 0; l < LEVEL_NUM; l++) {
+        group_num[l] = topo->GroupNum(l);
+        edges[l].assign((size_t)group_num[l] * group_num[l], 0);
+        limits[l].assign((size_t)group_num[l] * group_num[l], 0);
+    }
+}
+
+void LevelGraph::Build(const AdjacencyMatrix &G, int disk_num) {
+    for (int l = 0; l < LEVEL_NUM; l++) {
+        edges[l].assign(edges[l].size(), 0);
+    }
+    for (int i = 0; i < disk_num; i++) {
+        for (int j = i + 1; j < disk_num; j++) {
+            edge_t e = G.Get(i, j);
+            if (e != 0) Add(i, j, e);
+        }
+    }
+}
+
+void LevelGraph::SetBounds(int disk_num, int k, int stripe_num, int n) {
+    long long numer = (long long)k * stripe_num * n;
+    long long denom = (long long)disk_num * (disk_num - 1);
+    for (int l = 0; l < LEVEL_NUM; l++) {
+        size[l].assign(group_num[l], 0);
+        for (int i = 0; i < disk_num; i++) {
+            size[l][topo->Group(l, i)]++;
+        }
+        for (int u = 0; u < group_num[l]; u++) {
+            for (int v = 0; v < group_num[l]; v++) {
+                limits[l][u * group_num[l] + v] = size[l][u] * size[l][v] * numer / denom + 1;
+            }
+        }
+    }
+}
+
+double LevelGraph::Load(int src, int dst, const int *members, int n) const {
+    double load = 0;
+    for (int l = 0; l < LEVEL_NUM; l++) {
+        int gs = topo->Group(l, src), gd = topo->Group(l, dst);
+        //src与dst在同一组时迁移不改变这一层的边数
+        if (gs == gd) continue;
+        const long long *row = &edges[l][gd * group_num[l]];
+        const long long *limit = &limits[l][gd * group_num[l]];
+        //只有dst所在组与其他组之间的边数会增加：gm中的每个块与dst形成一条新边，
+        //同时dst所在组中的每个块与src之间的边被删除，抵消(gd, gs)的部分增量
+        for (int i = 0; i < n; i++) {
+            if (members[i] == src) continue;
+            int gm = topo->Group(l, members[i]);
+            if (gm == gd || size[l][gm] == 0) continue;
+            bool seen = false;
+            long long delta = 0;
+            for (int j = 0; j < n; j++) {
+                if (members[j] == src) continue;
+                int g = topo->Group(l, members[j]);
+                if (g == gm) {
+                    if (j < i) seen = true;
+                    delta++;
+                } else if (g == gd && gm == gs) {
+                    delta--;
+                }
+            }
+            if (!seen && delta > 0) load = max(load, (double)(row[gm] + delta) / limit[gm]);
+        }
+    }
+    return load;
+}
+
+void LevelGraph::Worst(int level, long long &edge, long long &limit) const {
+    edge = 0;
+    limit = 0;
+    int num = group_num[level];
+    for (int u = 0; u < num; u++) {
+        for (int v = u + 1; v < num; v++) {
+            if (size[level][u] == 0 || size[level][v] == 0) continue;
+            long long e = edges[level][u * num + v], b = limits[level][u * num + v];
+            //按e/b比较，用交叉相乘避免除法
+            if (limit == 0 || e * limit > edge * b) {
+                edge = e;
+                limit = b;
+            }
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/*********************************************************************************
+  * FileName:  topology.h
+  * Author:  Yazhe Zhang
+  * Date:  2021.4.17
+  * Description:  节点-主机-机架的拓扑，以及按主机、机架聚合的邻接矩阵与各层的理想最优解
+**********************************************************************************/
+
+#ifndef SUD_SCALE_SIMULATION_TOPOLOGY_H
+#define SUD_SCALE_SIMULATION_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+using namespace std;
+
+/*拓扑中节点之上的层级*/
+enum TopologyLevel {
+    LEVEL_HOST,     //同一主机上的节点之间的传输不经过网络
+    LEVEL_RACK,     //同一机架内的传输不经过机架上行链路
+    LEVEL_NUM
+};
+
+/*
+ * 每个节点所属的主机与机架。一台主机只能属于一个机架，主机号与机架号按在文件中首次出现的顺序编号
+ */
+class Topology {
+public:
+    /**
+     * @brief   读取拓扑文件。每个非空、非#开头的行为: first[-last] host rack，表示节点first到last（含）
+                位于主机host，主机位于机架rack，host与rack为不含空白的名字
+     * @return  成功返回0，失败返回-1并在err中给出原因
+     */
+    int Load(const string &path, string &err);
+    /**
+     * @brief   检查前disk_num个节点是否都指定了主机与机架
+     */
+    int Covers(int disk_num, string &err) const;
+
+    int Group(int level, int disk) const { return group[level][disk]; }
+    int GroupNum(int level) const { return names[level].size(); }
+    const string &GroupName(int level, int id) const { return names[level][id]; }
+
+private:
+    int GroupId(int level, const string &name);
+
+    vector<int> group[LEVEL_NUM];       //每个节点所属的主机号与机架号，-1表示未指定
+    vector<string> names[LEVEL_NUM];    //主机与机架的名字
+};
+
+/*
+ * 按主机、机架聚合的邻接矩阵：E[u][v]为u中的节点与v中的节点之间的边数之和（u≠v），
+ * 即u与v中任一节点故障时经过u、v之间链路的恢复传输量。
+ * 各层的理想最优解与节点对的理想最优解按同样的方式计算：每对节点的平均传输量为
+ * k*S*n/(D*(D-1))，主机或机架u、v之间的上限为|u|*|v|乘以该值取整后加1，|u|为u中前D个节点的个数
+ */
+class LevelGraph {
+public:
+    LevelGraph() : topo(nullptr) {}
+
+    /**
+     * @brief   设置拓扑并清零，topo为空时不做任何统计
+     */
+    void Reset(const Topology *topology);
+    bool Active() const { return topo != nullptr; }
+    /**
+     * @brief   由前disk_num个节点构成的邻接矩阵重新计算聚合的边数
+     */
+    void Build(const AdjacencyMatrix &G, int disk_num);
+    /**
+     * @brief   节点a与节点b之间的边数变化delta时同步更新各层
+     */
+    void Add(int a, int b, int delta) {
+        for (int l = 0; l < LEVEL_NUM; l++) {
+            int u = topo->Group(l, a), v = topo->Group(l, b);
+            if (u == v) continue;
+            edges[l][u * group_num[l] + v] += delta;
+            edges[l][v * group_num[l] + u] += delta;
+        }
+    }
+    /**
+     * @brief   按扩缩容后的前disk_num个节点计算各层每对主机、机架之间的上限
+     */
+    void SetBounds(int disk_num, int k, int stripe_num, int n);
+    /**
+     * @brief   把条带中位于src的块迁移到dst后，各层中边数增加的主机、机架对里边数与上限之比的最大值
+     * @param   members 条带中各块所在的节点，其中包含src
+                缩容时将被移除的主机、机架在扩缩容后没有节点，与它们之间的边最终都会消失，不参与计算
+     * @return  不超过1表示迁移后各层都不超过上限；没有边数增加的组对时返回0
+     */
+    double Load(int src, int dst, const int *members, int n) const;
+    bool Exceeds(int src, int dst, const int *members, int n) const { return Load(src, dst, members, n) > 1; }
+    /**
+     * @brief   第level层中边数与上限之比最大的一对，返回其边数与上限；不考虑扩缩容后没有节点的主机、机架，
+                没有跨组的节点对时都为0
+     */
+    void Worst(int level, long long &edge, long long &limit) const;
+
+    long long Get(int level, int u, int v) const { return edges[level][u * group_num[level] + v]; }
+    long long Limit(int level, int u, int v) const { return limits[level][u * group_num[level] + v]; }
+
+private:
+    const Topology *topo;
+    int group_num[LEVEL_NUM];
+    vector<long long> edges[LEVEL_NUM];     //聚合的边数，按行完整存储
+    vector<long long> limits[LEVEL_NUM];    //每对主机、机架之间的上限
+    vector<long long> size[LEVEL_NUM];      //SetBounds时每个主机、机架在前disk_num个节点中的节点数
+};
+
+#endif //SUD_SCALE_SIMULATION_TOPOLOGY_H